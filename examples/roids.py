@@ -40,8 +40,8 @@ def main():
                 max_velocity=10,    # max velocity of polygon
                 counter=0):
 
-            # scale the polygon if scale was given
-            self.polygon = (
+            # scale the polygon if scale was given, then parse it once
+            self.polygon = s3lcd.Polygon(
                 polygon if scale is None else [(int(scale*x[0]), int(scale*x[1])) for x in polygon])
 
             # if no location given assign a random location
@@ -94,15 +94,15 @@ def main():
             second_ang = second * pi_div_30
 
             # draw and fill the hour hand polygon rotated to hour_ang
-            tft.fill_polygon(hour_poly, center_x, center_y, s3lcd.BLACK, 255, hour_ang)
+            tft.aa_fill_polygon(hour_poly, center_x, center_y, s3lcd.BLACK, 255, hour_ang)
 
             # draw and fill the minute hand polygon rotated to minute_ang
-            tft.fill_polygon(
+            tft.aa_fill_polygon(
                 minute_poly, center_x, center_y, s3lcd.BLACK, 255, minute_ang
             )
 
             # draw and fill the second hand polygon rotated to second_ang
-            tft.fill_polygon(
+            tft.aa_fill_polygon(
                 second_poly, center_x, center_y, s3lcd.RED, 255, second_ang
             )
 
@@ -4,8 +4,12 @@ add_library(usermod_s3lcd INTERFACE)
 # Add our source files to the lib
 target_sources(usermod_s3lcd INTERFACE
     ${CMAKE_CURRENT_LIST_DIR}/s3lcd.c
+    ${CMAKE_CURRENT_LIST_DIR}/s3lcd_font.c
+    ${CMAKE_CURRENT_LIST_DIR}/s3lcd_hershey.c
     ${CMAKE_CURRENT_LIST_DIR}/s3lcd_i80_bus.c
+    ${CMAKE_CURRENT_LIST_DIR}/s3lcd_raster.c
     ${CMAKE_CURRENT_LIST_DIR}/s3lcd_spi_bus.c
+    ${CMAKE_CURRENT_LIST_DIR}/s3lcd_ttf.c
     ${CMAKE_CURRENT_LIST_DIR}/mpfile.c
     ${CMAKE_CURRENT_LIST_DIR}/jpg/tjpgd565.c
     ${CMAKE_CURRENT_LIST_DIR}/png/pngle.c
@@ -91,12 +91,15 @@ off_t mp_tell(mp_file_t *file) {
 
 void mp_close(mp_file_t *file) {
 
-    mp_obj_t close_fn = mp_load_attr(file->file_obj, MP_QSTR_close);
+    // load close as a method so no bound method is allocated, this lets a
+    // finaliser close a file while the heap is locked
+    mp_obj_t close_method[2];
+    mp_load_method(file->file_obj, MP_QSTR_close, close_method);
     file->file_obj = mp_const_none;
     file->readinto_fn = mp_const_none;
     file->seek_fn = mp_const_none;
     file->tell_fn = mp_const_none;
-    mp_call_function_0(close_fn);
+    mp_call_method_n_kw(0, 0, close_method);
 }
 
 static void mp_file_print(const mp_print_t *print, mp_obj_t self, mp_print_kind_t kind) {
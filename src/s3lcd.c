@@ -48,6 +48,7 @@
 #include "py/objmodule.h"
 #include "py/runtime.h"
 #include "py/builtin.h"
+#include "py/binary.h"
 #include "py/mphal.h"
 
 // Fix for MicroPython > 1.21 https://github.com/ricksorensen
@@ -59,7 +60,10 @@
 
 #include "mpfile.h"
 #include "s3lcd.h"
+#include "s3lcd_font.h"
+#include "s3lcd_hershey.h"
 #include "s3lcd_i80_bus.h"
+#include "s3lcd_raster.h"
 #include "s3lcd_spi_bus.h"
 
 #include "jpg/tjpgd565.h"
@@ -244,6 +248,17 @@ static void _setpixel(s3lcd_obj_t *self, uint16_t x, uint16_t y, uint16_t color,
 //     return *(self->frame_buffer + x + y * self->width);
 // }
 
+//
+// frame_buffer_required: raise an error for drawing methods called before
+// init() or on a display created with frame_buffer=False.
+//
+
+static void frame_buffer_required(s3lcd_obj_t *self) {
+    if (self->frame_buffer == NULL) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("method requires a framebuffer"));
+    }
+}
+
 static void _fill(s3lcd_obj_t *self, uint16_t color) {
     uint16_t *b = self->frame_buffer;
     for (size_t i = 0; i < self->width * self->height; ++i) {
@@ -283,11 +298,56 @@ static void _fill_rect(s3lcd_obj_t *self, uint16_t x, uint16_t y, uint16_t w, ui
     }
 }
 
+//
+// fill_rect_clipped: fill a rectangle that may extend past any edge of the
+// frame buffer.
+//
+
+static void fill_rect_clipped(s3lcd_obj_t *self, int x, int y, int w, int h, uint16_t color, uint8_t alpha) {
+    int x0 = (x < 0) ? 0 : x;
+    int y0 = (y < 0) ? 0 : y;
+    int x1 = (x + w > self->width) ? self->width : x + w;
+    int y1 = (y + h > self->height) ? self->height : y + h;
+    if (x0 < x1 && y0 < y1) {
+        _fill_rect(self, x0, y0, x1 - x0, y1 - y0, color, alpha);
+    }
+}
+
 static int mod(int x, int m) {
     int r = x % m;
     return (r < 0) ? r + m : r;
 }
 
+//
+// fill_rect_wrap: fill a rectangle wrapped around the edges the WRAP options
+// select and clipped to the others.
+//
+
+static void fill_rect_wrap(s3lcd_obj_t *self, int x, int y, int w, int h, uint16_t color, uint8_t alpha) {
+    bool wrap_h = (self->options & OPTIONS_WRAP_H) != 0;
+    bool wrap_v = (self->options & OPTIONS_WRAP_V) != 0;
+    if (wrap_h) {
+        x = mod(x, self->width);
+        w = (w > self->width) ? self->width : w;
+    }
+    if (wrap_v) {
+        y = mod(y, self->height);
+        h = (h > self->height) ? self->height : h;
+    }
+
+    // the part past the right or bottom edge is drawn again from 0
+    fill_rect_clipped(self, x, y, w, h, color, alpha);
+    if (wrap_h && x + w > self->width) {
+        fill_rect_clipped(self, x - self->width, y, w, h, color, alpha);
+    }
+    if (wrap_v && y + h > self->height) {
+        fill_rect_clipped(self, x, y - self->height, w, h, color, alpha);
+        if (wrap_h && x + w > self->width) {
+            fill_rect_clipped(self, x - self->width, y - self->height, w, h, color, alpha);
+        }
+    }
+}
+
 void draw_pixel(s3lcd_obj_t *self, int16_t x, int16_t y, uint16_t color, uint8_t alpha) {
     if ((self->options & OPTIONS_WRAP)) {
         if ((self->options & OPTIONS_WRAP_H) && ((x >= self->width) || (x < 0))) {
@@ -405,6 +465,7 @@ static MP_DEFINE_CONST_FUN_OBJ_2(s3lcd_idle_mode_obj, s3lcd_idle_mode);
 
 static mp_obj_t s3lcd_fill_rect(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
     mp_int_t x = mp_obj_get_int(args[1]);
     mp_int_t y = mp_obj_get_int(args[2]);
     mp_int_t w = mp_obj_get_int(args[3]);
@@ -428,6 +489,7 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_fill_rect_obj, 6, 7, s3lcd_fill
 
 static mp_obj_t s3lcd_clear(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
     OPTIONAL_ARG(1, mp_int_t, mp_obj_get_int, color, BLACK)
     memset(self->frame_buffer, color & 0xff , self->frame_buffer_size);
     return mp_const_none;
@@ -445,6 +507,7 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_clear_obj, 2, 3, s3lcd_clear);
 
 static mp_obj_t s3lcd_fill(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
     OPTIONAL_ARG(1, mp_int_t, mp_obj_get_int, color, BLACK)
     // OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, alpha, 255)
 
@@ -467,6 +530,7 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_fill_obj, 2, 3, s3lcd_fill);
 
 static mp_obj_t s3lcd_pixel(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
     mp_int_t x = mp_obj_get_int(args[1]);
     mp_int_t y = mp_obj_get_int(args[2]);
     OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, color, WHITE)
@@ -478,7 +542,12 @@ static mp_obj_t s3lcd_pixel(size_t n_args, const mp_obj_t *args) {
 static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_pixel_obj, 4, 5, s3lcd_pixel);
 
 
-static void line(s3lcd_obj_t *self, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t color, uint8_t alpha) {
+//
+// line_wrap: Bresenham line drawn through draw_pixel and the fast line
+// functions so it wraps around the edges of the frame buffer.
+//
+
+static void line_wrap(s3lcd_obj_t *self, int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t color, uint8_t alpha) {
     bool steep = ABS(y1 - y0) > ABS(x1 - x0);
     if (steep) {
         _swap_int16_t(x0, y0);
@@ -539,6 +608,123 @@ static void line(s3lcd_obj_t *self, int16_t x0, int16_t y0, int16_t x1, int16_t
     }
 }
 
+//
+// outcode: Cohen-Sutherland region code of x, y relative to the frame buffer.
+//
+
+#define OUTCODE_LEFT 1
+#define OUTCODE_RIGHT 2
+#define OUTCODE_TOP 4
+#define OUTCODE_BOTTOM 8
+
+static inline int outcode(s3lcd_obj_t *self, int x, int y) {
+    return ((x < 0) ? OUTCODE_LEFT : (x >= self->width) ? OUTCODE_RIGHT : 0)
+           | ((y < 0) ? OUTCODE_TOP : (y >= self->height) ? OUTCODE_BOTTOM : 0);
+}
+
+//
+// line: draw a line from x0, y0 to x1, y1. Lines entirely on one side of the
+// frame buffer are rejected by their outcodes. Otherwise the steps of the
+// Bresenham line that are inside the frame buffer are found arithmetically,
+// so the clipped line has the same pixels as the unclipped one, and only
+// those steps are drawn, straight into the frame buffer.
+//
+
+static void line(s3lcd_obj_t *self, int x0, int y0, int x1, int y1, int16_t color, uint8_t alpha) {
+    if (self->options & OPTIONS_WRAP) {
+        line_wrap(self, x0, y0, x1, y1, color, alpha);
+        return;
+    }
+
+    if (outcode(self, x0, y0) & outcode(self, x1, y1)) {
+        return;
+    }
+
+    // step along the major axis from the lower end of the line
+    int32_t major0 = x0, minor0 = y0, major1 = x1, minor1 = y1;
+    int32_t major_size = self->width, minor_size = self->height;
+    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+    if (steep) {
+        major0 = y0;
+        minor0 = x0;
+        major1 = y1;
+        minor1 = x1;
+        major_size = self->height;
+        minor_size = self->width;
+    }
+    if (major0 > major1) {
+        int32_t t = major0;
+        major0 = major1;
+        major1 = t;
+        t = minor0;
+        minor0 = minor1;
+        minor1 = t;
+    }
+
+    const int32_t dx = major1 - major0;
+    const int32_t dy = ABS(minor1 - minor0);
+    const int32_t err0 = dx >> 1;
+    const int32_t ystep = (minor0 < minor1) ? 1 : -1;
+
+    // steps with the major axis inside the frame buffer
+    int64_t first = (major0 < 0) ? -major0 : 0;
+    int64_t last = (major1 >= major_size) ? major_size - 1 - major0 : dx;
+
+    // after step k the minor axis has moved m(k) = ceil((k * dy - err0) / dx)
+    // pixels, limit the steps to those with the minor axis inside
+    if (dy) {
+        int64_t m_lo = (ystep > 0) ? -minor0 : minor0 - (minor_size - 1);
+        int64_t m_hi = (ystep > 0) ? minor_size - 1 - minor0 : minor0;
+        if (m_lo < 0) {
+            m_lo = 0;
+        }
+        if (m_hi > dy) {
+            m_hi = dy;
+        }
+        if (m_lo > m_hi) {
+            return;
+        }
+        if (m_lo > 0) {
+            int64_t k = ((m_lo - 1) * dx + err0) / dy + 1;
+            first = (k > first) ? k : first;
+        }
+        int64_t k = (m_hi * dx + err0) / dy;
+        last = (k < last) ? k : last;
+    } else if (minor0 < 0 || minor0 >= minor_size) {
+        return;
+    }
+    if (first > last) {
+        return;
+    }
+
+    int64_t m = (first * dy > err0) ? (first * dy - err0 + dx - 1) / dx : 0;
+    int32_t err = err0 - first * dy + m * dx;
+    int32_t major = major0 + first;
+    int32_t minor = minor0 + ystep * m;
+
+    uint16_t *b;
+    int32_t major_stride, minor_stride;
+    if (steep) {
+        b = &self->frame_buffer[major * self->width + minor];
+        major_stride = self->width;
+        minor_stride = ystep;
+    } else {
+        b = &self->frame_buffer[minor * self->width + major];
+        major_stride = 1;
+        minor_stride = ystep * self->width;
+    }
+
+    for (int32_t count = last - first + 1; count; count--) {
+        *b = (alpha == 255) ? (uint16_t)color : alpha_blend_565(color, *b, alpha);
+        err -= dy;
+        if (err < 0) {
+            err += dx;
+            b += minor_stride;
+        }
+        b += major_stride;
+    }
+}
+
 ///
 /// .line(x0, y0, x1, y1{, color, alpha})
 /// Draw a line from (x0, y0) to (x1, y1).
@@ -554,6 +740,7 @@ static void line(s3lcd_obj_t *self, int16_t x0, int16_t y0, int16_t x1, int16_t
 
 static mp_obj_t s3lcd_line(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
     mp_int_t x0 = mp_obj_get_int(args[1]);
     mp_int_t y0 = mp_obj_get_int(args[2]);
     mp_int_t x1 = mp_obj_get_int(args[3]);
@@ -566,9 +753,205 @@ static mp_obj_t s3lcd_line(size_t n_args, const mp_obj_t *args) {
 }
 static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_line_obj, 6, 7, s3lcd_line);
 
+//
+// Anti-aliased lines and circles
+//
+// Lines and circles are drawn with Xiaolin Wu's algorithm: each step along
+// the major axis covers the two pixels nearest the true position on the minor
+// axis, weighted by the fraction of the position past the first pixel. The
+// position is kept as a 32.32 fixed-point sum so no step divides.
+//
+
+//
+// blend_pixel: blend color over the pixel at x, y with coverage 0 to 255,
+// ignoring pixels off the frame buffer.
+//
+
+static inline void blend_pixel(s3lcd_obj_t *self, int x, int y, uint16_t color, uint8_t coverage) {
+    if ((unsigned)x < self->width && (unsigned)y < self->height && coverage) {
+        uint16_t *b = &self->frame_buffer[y * self->width + x];
+        *b = (coverage == 255) ? color : alpha_blend_565(color, *b, coverage);
+    }
+}
+
+// aa_line end points are 24.8 fixed-point pixels
+
+#define AA_SHIFT 8
+#define AA_ONE (1 << AA_SHIFT)
+#define AA_FIXED(v) ((int32_t)(v) * AA_ONE)
+#define AA_ROUND(v) (((v) + AA_ONE / 2) >> AA_SHIFT)
+
+//
+// aa_outcode: outcode of a fixed-point point for aa_line, which can draw the
+// pixels from its floor to one past it.
+//
+
+static inline int aa_outcode(s3lcd_obj_t *self, int32_t x, int32_t y) {
+    int fx = x >> AA_SHIFT;
+    int fy = y >> AA_SHIFT;
+    return ((fx < -1) ? OUTCODE_LEFT : (fx >= self->width) ? OUTCODE_RIGHT : 0)
+           | ((fy < -1) ? OUTCODE_TOP : (fy >= self->height) ? OUTCODE_BOTTOM : 0);
+}
+
+//
+// aa_line: draw an anti-aliased line from x0, y0 to x1, y1, given in 24.8
+// fixed-point pixels, including the last point if last is true. One pixel
+// is drawn on each side of the line for every whole pixel on the major axis
+// between the rounded end points. Only the steps inside the frame buffer on
+// the major axis are drawn, and blend_pixel drops either pixel of a step
+// that falls off it on the minor axis.
+//
+
+static void aa_line(s3lcd_obj_t *self, int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color, uint8_t alpha, bool last) {
+    if (aa_outcode(self, x0, y0) & aa_outcode(self, x1, y1)) {
+        return;
+    }
+
+    bool steep = ABS(y1 - y0) > ABS(x1 - x0);
+    int32_t major0 = steep ? y0 : x0, minor0 = steep ? x0 : y0;
+    int32_t major1 = steep ? y1 : x1, minor1 = steep ? x1 : y1;
+    int32_t major_size = steep ? self->height : self->width;
+
+    // whole pixels on the major axis, skipping the last if it is not wanted
+    int32_t first = AA_ROUND(major0);
+    int32_t final = AA_ROUND(major1);
+    if (!last) {
+        if (first == final) {
+            return;
+        }
+        final += (first < final) ? -1 : 1;
+    }
+    int32_t lo = (first < final) ? first : final;
+    int32_t hi = (first < final) ? final : first;
+    lo = (lo < 0) ? 0 : lo;
+    hi = (hi >= major_size) ? major_size - 1 : hi;
+    if (lo > hi) {
+        return;
+    }
+
+    // minor axis position at each step in 32.32 fixed-point pixels
+    int64_t slope = (major1 != major0) ? ((int64_t)(minor1 - minor0) << 32) / (major1 - major0) : 0;
+    int64_t pos = ((int64_t)minor0 << (32 - AA_SHIFT)) + ((((int64_t)lo << AA_SHIFT) - major0) * slope >> AA_SHIFT);
+
+    for (int32_t major = lo; major <= hi; major++) {
+        int32_t minor = (int32_t)(pos >> 32);
+        uint8_t weight = (uint8_t)(pos >> 24);
+        uint8_t near = (255 - weight) * alpha / 255;
+        uint8_t far = weight * alpha / 255;
+        if (steep) {
+            blend_pixel(self, minor, major, color, near);
+            blend_pixel(self, minor + 1, major, color, far);
+        } else {
+            blend_pixel(self, major, minor, color, near);
+            blend_pixel(self, major, minor + 1, color, far);
+        }
+        pos += slope;
+    }
+}
+
+///
+/// .aa_line(x0, y0, x1, y1{, color, alpha})
+/// Draw an anti-aliased line from (x0, y0) to (x1, y1).
+/// required parameters:
+/// -- x0: x coordinate of the start of the line
+/// -- y0: y coordinate of the start of the line
+/// -- x1: x coordinate of the end of the line
+/// -- y1: y coordinate of the end of the line
+/// optional parameters:
+/// -- color defaults to WHITE
+/// -- alpha defaults to 255
+///
+
+static mp_obj_t s3lcd_aa_line(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t x0 = mp_obj_get_int(args[1]);
+    mp_int_t y0 = mp_obj_get_int(args[2]);
+    mp_int_t x1 = mp_obj_get_int(args[3]);
+    mp_int_t y1 = mp_obj_get_int(args[4]);
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    aa_line(self, AA_FIXED(x0), AA_FIXED(y0), AA_FIXED(x1), AA_FIXED(y1), color, alpha, true);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_aa_line_obj, 5, 7, s3lcd_aa_line);
+
+//
+// blit_part: copy or blend w by h pixels of an RGB565 buffer with rows of
+// stride pixels to x, y, clipped to the frame buffer.
+//
+
+static void blit_part(s3lcd_obj_t *self, const uint16_t *buffer, mp_int_t stride, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h, uint8_t alpha) {
+    mp_int_t left = (x < 0) ? -x : 0;
+    mp_int_t top = (y < 0) ? -y : 0;
+    mp_int_t right = (x + w > self->width) ? self->width - x : w;
+    mp_int_t bottom = (y + h > self->height) ? self->height - y : h;
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    for (mp_int_t row = top; row < bottom; row++) {
+        const uint16_t *src = buffer + row * stride + left;
+        uint16_t *dst = &self->frame_buffer[(y + row) * self->width + x + left];
+        if (alpha == 255) {
+            memcpy(dst, src, (right - left) * sizeof(uint16_t));
+        } else {
+            for (mp_int_t col = left; col < right; col++) {
+                *dst = alpha_blend_565(*src++, *dst, alpha);
+                dst++;
+            }
+        }
+    }
+}
+
+//
+// blit_clipped: copy or blend a w by h RGB565 buffer to x, y, clipped to the
+// frame buffer, or wrapped around the edges the WRAP options select.
+//
+
+static void blit_clipped(s3lcd_obj_t *self, mp_obj_t buffer, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h, uint8_t alpha) {
+    mp_buffer_info_t buf_info;
+    mp_get_buffer_raise(buffer, &buf_info, MP_BUFFER_READ);
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    if (buf_info.len < (size_t)(w * h * 2)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("buffer size too small for width and height"));
+    }
+    if (alpha == 0) {
+        return;
+    }
+
+    bool wrap_h = (self->options & OPTIONS_WRAP_H) != 0;
+    bool wrap_v = (self->options & OPTIONS_WRAP_V) != 0;
+    mp_int_t stride = w;
+    if (wrap_h) {
+        x = mod(x, self->width);
+        w = (w > self->width) ? self->width : w;
+    }
+    if (wrap_v) {
+        y = mod(y, self->height);
+        h = (h > self->height) ? self->height : h;
+    }
+
+    // the part past the right or bottom edge is drawn again from 0
+    blit_part(self, buf_info.buf, stride, x, y, w, h, alpha);
+    if (wrap_h && x + w > self->width) {
+        blit_part(self, buf_info.buf, stride, x - self->width, y, w, h, alpha);
+    }
+    if (wrap_v && y + h > self->height) {
+        blit_part(self, buf_info.buf, stride, x, y - self->height, w, h, alpha);
+        if (wrap_h && x + w > self->width) {
+            blit_part(self, buf_info.buf, stride, x - self->width, y - self->height, w, h, alpha);
+        }
+    }
+}
+
 ///
 /// .blit_buffer(buffer, x, y, width, height {,alpha})
-/// Draw a buffer to the screen.
+/// Draw a buffer to the screen, wrapped around the edges the WRAP options
+/// select.
 /// required parameters:
 /// -- buffer: a buffer object containing the image data
 /// -- x: x coordinate of the top left corner of the image
@@ -581,154 +964,505 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_line_obj, 6, 7, s3lcd_line);
 
 static mp_obj_t s3lcd_blit_buffer(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_buffer_info_t buf_info;
-    mp_get_buffer_raise(args[1], &buf_info, MP_BUFFER_READ);
+    frame_buffer_required(self);
     mp_int_t x = mp_obj_get_int(args[2]);
     mp_int_t y = mp_obj_get_int(args[3]);
     mp_int_t w = mp_obj_get_int(args[4]);
     mp_int_t h = mp_obj_get_int(args[5]);
     OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, alpha, 255)
 
-    uint16_t *src = buf_info.buf;
-    uint16_t stride = self->width - w;
-    uint16_t *dst = (uint16_t *) self->frame_buffer + (y * self->width + x);
+    blit_clipped(self, args[1], x, y, w, h, alpha);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_blit_buffer_obj, 6, 7, s3lcd_blit_buffer);
 
-    for (int yy = 0; yy < h; yy++) {
-        for (int xx = 0; xx < w; xx++) {
-            if (xx+x < 0 || xx+x >= self->width || yy+y < 0 || yy+y >= self->height) {
-                src++;
-                dst++;
-            }
-            else {
-                *dst = alpha_blend_565(*src, *dst, alpha);
-                src++;
-                dst++;
-            }
-        }
-        dst += stride;
+//
+// Batched drawing. The pixels, lines and rects methods draw every command
+// in an array('h') or memoryview of int16 values in one call. Each command
+// is the coordinates of one primitive followed by its color, unless a color
+// is given for the whole batch.
+//
+
+static size_t batch_get(mp_obj_t data, size_t values, const int16_t **commands) {
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(data, &bufinfo, MP_BUFFER_READ);
+    if (bufinfo.typecode != 'h' && bufinfo.typecode != 'H') {
+        mp_raise_TypeError(MP_ERROR_TEXT("array('h') required"));
+    }
+    size_t len = bufinfo.len / sizeof(int16_t);
+    if (len % values) {
+        mp_raise_ValueError(MP_ERROR_TEXT("array length must be a multiple of the command size"));
     }
+    *commands = bufinfo.buf;
+    return len / values;
+}
+
+///
+/// .pixels(data {, color, alpha})
+/// Draw many pixels.
+/// required parameters:
+/// -- data: array('h') of x, y, color values, or x, y values if color is given
+/// optional parameters:
+/// -- color: color of every pixel
+/// -- alpha: alpha value, defaults to 255
+///
 
+static mp_obj_t s3lcd_pixels(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    bool has_color = n_args > 2;
+    OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    const int16_t *cmd;
+    size_t values = has_color ? 2 : 3;
+    size_t count = batch_get(args[1], values, &cmd);
+    bool wrap = (self->options & OPTIONS_WRAP) != 0;
+
+    for (; count; count--, cmd += values) {
+        uint16_t c = has_color ? color : (uint16_t)cmd[2];
+        if (wrap) {
+            draw_pixel(self, cmd[0], cmd[1], c, alpha);
+        } else if ((unsigned)cmd[0] < self->width && (unsigned)cmd[1] < self->height) {
+            uint16_t *b = &self->frame_buffer[cmd[1] * self->width + cmd[0]];
+            *b = alpha_blend_565(c, *b, alpha);
+        }
+    }
     return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_blit_buffer_obj, 6, 7, s3lcd_blit_buffer);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_pixels_obj, 2, 4, s3lcd_pixels);
 
 ///
-/// .draw(font, string|int, x, y, {color , scale, alpha})
-/// Draw a string or a single character.
+/// .lines(data {, color, alpha})
+/// Draw many lines.
 /// required parameters:
-/// -- font: a font module
-/// -- string: a string or a single character
-/// -- x: x coordinate of the top left corner of the string
-/// -- y: y coordinate of the top left corner of the string
+/// -- data: array('h') of x0, y0, x1, y1, color values, or x0, y0, x1, y1
+///    values if color is given
 /// optional parameters:
-/// -- color defaults to WHITE
-/// -- scale defaults to 1
-/// -- alpha defaults to 255
+/// -- color: color of every line
+/// -- alpha: alpha value, defaults to 255
 ///
 
-static mp_obj_t s3lcd_draw(size_t n_args, const mp_obj_t *args) {
+static mp_obj_t s3lcd_lines(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    char single_char_s[] = {0, 0};
-    const char *s;
+    frame_buffer_required(self);
+    bool has_color = n_args > 2;
+    OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, alpha, 255)
 
-    mp_obj_module_t *hershey = MP_OBJ_TO_PTR(args[1]);
+    const int16_t *cmd;
+    size_t values = has_color ? 4 : 5;
+    size_t count = batch_get(args[1], values, &cmd);
 
-    if (mp_obj_is_int(args[2])) {
-        mp_int_t c = mp_obj_get_int(args[2]);
-        single_char_s[0] = c & 0xff;
-        s = single_char_s;
-    } else {
-        s = mp_obj_str_get_str(args[2]);
+    for (; count; count--, cmd += values) {
+        line(self, cmd[0], cmd[1], cmd[2], cmd[3], has_color ? color : (uint16_t)cmd[4], alpha);
     }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_lines_obj, 2, 4, s3lcd_lines);
 
-    mp_int_t x = mp_obj_get_int(args[3]);
-    mp_int_t y = mp_obj_get_int(args[4]);
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, color, WHITE)
+///
+/// .rects(data {, color, alpha})
+/// Draw many filled rectangles, wrapped around the edges the WRAP options
+/// select.
+/// required parameters:
+/// -- data: array('h') of x, y, w, h, color values, or x, y, w, h values if
+///    color is given
+/// optional parameters:
+/// -- color: color of every rectangle
+/// -- alpha: alpha value, defaults to 255
+///
 
-    mp_float_t scale = 1.0;
-    if (n_args > 6) {
-        if (mp_obj_is_float(args[6])) {
-            scale = mp_obj_float_get(args[6]);
-        }
-        if (mp_obj_is_int(args[6])) {
-            scale = (mp_float_t)mp_obj_get_int(args[6]);
-        }
+static mp_obj_t s3lcd_rects(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    bool has_color = n_args > 2;
+    OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    const int16_t *cmd;
+    size_t values = has_color ? 4 : 5;
+    size_t count = batch_get(args[1], values, &cmd);
+
+    for (; count; count--, cmd += values) {
+        fill_rect_wrap(self, cmd[0], cmd[1], cmd[2], cmd[3], has_color ? color : (uint16_t)cmd[4], alpha);
     }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_rects_obj, 2, 4, s3lcd_rects);
 
-    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, alpha, 255)
+///
+/// .blits(blits)
+/// Draw many buffers.
+/// required parameters:
+/// -- blits: a list of (buffer, x, y, width, height {, alpha}) tuples with
+///    the same arguments as blit_buffer
+///
 
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(hershey->globals);
-    mp_obj_t *index_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_INDEX));
-    mp_buffer_info_t index_bufinfo;
-    mp_get_buffer_raise(index_data_buff, &index_bufinfo, MP_BUFFER_READ);
-    uint8_t *index = index_bufinfo.buf;
+static mp_obj_t s3lcd_blits(mp_obj_t self_in, mp_obj_t blits_in) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    frame_buffer_required(self);
+    size_t blits_len;
+    mp_obj_t *blits;
+    mp_obj_get_array(blits_in, &blits_len, &blits);
 
-    mp_obj_t *font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));
-    mp_buffer_info_t font_bufinfo;
-    mp_get_buffer_raise(font_data_buff, &font_bufinfo, MP_BUFFER_READ);
-    int8_t *font = font_bufinfo.buf;
+    for (size_t idx = 0; idx < blits_len; idx++) {
+        size_t len;
+        mp_obj_t *blit;
+        mp_obj_get_array(blits[idx], &len, &blit);
+        if (len < 5) {
+            mp_raise_ValueError(MP_ERROR_TEXT("blit must be (buffer, x, y, width, height {, alpha})"));
+        }
+        blit_clipped(
+            self,
+            blit[0],
+            mp_obj_get_int(blit[1]),
+            mp_obj_get_int(blit[2]),
+            mp_obj_get_int(blit[3]),
+            mp_obj_get_int(blit[4]),
+            (len > 5) ? mp_obj_get_int(blit[5]) : 255);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(s3lcd_blits_obj, s3lcd_blits);
 
-    int16_t from_x = x;
-    int16_t from_y = y;
-    int16_t to_x = x;
-    int16_t to_y = y;
-    int16_t pos_x = x;
-    int16_t pos_y = y;
-    bool penup = true;
-    char c;
-    int16_t ii;
+//
+// blend_coverage: blend color into the w x h frame buffer area at x, y using
+// the 8 bit coverage of each pixel, clipped to the frame buffer.
+//
 
-    while ((c = *s++)) {
-        if (c >= 32 && c <= 127) {
-            ii = (c - 32) * 2;
+static void blend_coverage(s3lcd_obj_t *self, int x, int y, const uint8_t *coverage, int w, int h,
+    uint16_t color, uint8_t alpha) {
+
+    int left = (x < 0) ? -x : 0;
+    int top = (y < 0) ? -y : 0;
+    int right = (x + w > self->width) ? self->width - x : w;
+    int bottom = (y + h > self->height) ? self->height - y : h;
+
+    for (int row = top; row < bottom; row++) {
+        const uint8_t *src = coverage + row * w + left;
+        uint16_t *dst = &self->frame_buffer[(y + row) * self->width + x + left];
+        for (int col = left; col < right; col++, src++, dst++) {
+            if (*src) {
+                uint8_t a = (*src * alpha) / 255;
+                *dst = (a == 255) ? color : alpha_blend_565(color, *dst, a);
+            }
+        }
+    }
+}
 
-            int16_t offset = index[ii] | (index[ii + 1] << 8);
-            int16_t length = font[offset++];
-            int16_t left = (int)(scale * (font[offset++] - 0x52) + 0.5);
-            int16_t right = (int)(scale * (font[offset++] - 0x52) + 0.5);
-            int16_t width = right - left;
+//
+// Stroked Hershey glyphs
+//
+// Glyphs drawn with a stroke width or anti-aliasing are rendered one glyph at
+// a time. Each segment is rasterized as a capsule, a line with round ends as
+// wide as the stroke, into a coverage buffer for the whole glyph that keeps
+// the highest coverage of each pixel so joints are not blended twice. The
+// buffer is then blended into the frame buffer in one pass.
+//
 
-            if (length) {
-                int16_t i;
-                for (i = 0; i < length; i++) {
-                    if (font[offset] == ' ') {
-                        offset += 2;
-                        penup = true;
-                        continue;
-                    }
+typedef struct _stroke_t {
+    uint16_t color;                         // stroke color
+    uint8_t alpha;                          // stroke alpha
+    bool thick;                             // draw capsules instead of lines
+    bool aa;                                // anti-alias capsule edges
+    mp_float_t radius;                      // half the stroke width
+    uint8_t *coverage;                      // glyph coverage buffer
+    size_t coverage_size;                   // size of coverage buffer in bytes
+} stroke_t;
 
-                    int16_t vector_x = (int)(scale * (font[offset++] - 0x52) + 0.5);
-                    int16_t vector_y = (int)(scale * (font[offset++] - 0x52) + 0.5);
+//
+// stroke_capsule: add the coverage of the capsule from x0, y0 to x1, y1 to
+// the w x h coverage buffer, all coordinates are relative to the buffer.
+//
 
-                    if (!i || penup) {
-                        from_x = pos_x + vector_x - left;
-                        from_y = pos_y + vector_y;
-                    } else {
-                        to_x = pos_x + vector_x - left;
-                        to_y = pos_y + vector_y;
+static void stroke_capsule(uint8_t *coverage, int w, int h, int x0, int y0, int x1, int y1,
+    mp_float_t radius, bool aa) {
+
+    mp_float_t reach = aa ? radius + MICROPY_FLOAT_CONST(0.5) : radius;
+    mp_float_t reach2 = reach * reach;
+    int pad = (int)reach + 1;
+
+    int min_x = MAX(0, MIN(x0, x1) - pad);
+    int max_x = MIN(w - 1, MAX(x0, x1) + pad);
+    int min_y = MAX(0, MIN(y0, y1) - pad);
+    int max_y = MIN(h - 1, MAX(y0, y1) + pad);
+
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int len2 = dx * dx + dy * dy;
+
+    for (int py = min_y; py <= max_y; py++) {
+        uint8_t *p = coverage + py * w + min_x;
+        for (int px = min_x; px <= max_x; px++, p++) {
+            int rx = px - x0;
+            int ry = py - y0;
+
+            // distance from the pixel to the closest point on the segment
+            mp_float_t t = 0;
+            if (len2) {
+                int dot = rx * dx + ry * dy;
+                t = (dot <= 0) ? 0 : (dot >= len2) ? 1 : (mp_float_t)dot / len2;
+            }
+            mp_float_t ex = rx - t * dx;
+            mp_float_t ey = ry - t * dy;
+            mp_float_t d2 = ex * ex + ey * ey;
+            if (d2 >= reach2) {
+                continue;
+            }
 
-                        line(self, from_x, from_y, to_x, to_y, color, alpha);
-                        from_x = to_x;
-                        from_y = to_y;
-                    }
-                    penup = false;
+            uint8_t c = 255;
+            if (aa) {
+                mp_float_t edge = reach - MICROPY_FLOAT_C_FUN(sqrt)(d2);
+                if (edge < 1) {
+                    c = (uint8_t)(edge * 255);
                 }
             }
-            pos_x += width;
+            if (c > *p) {
+                *p = c;
+            }
         }
     }
-    return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_draw_obj, 5, 8, s3lcd_draw);
 
-///
-/// .draw_len(font, string|int {, scale})
+//
+// stroke_glyph: draw count vertices relative to the glyph origin ox, oy as
+// connected segments, HERSHEY_PENUP vertices start a new stroke.
+//
+
+static void stroke_glyph(s3lcd_obj_t *self, stroke_t *stroke, const int16_t *v, int count, int16_t ox, int16_t oy) {
+    if (!stroke->thick) {
+        int16_t from_x = 0, from_y = 0;
+        bool penup = true;
+        for (int i = 0; i < count; i++, v += 2) {
+            if (v[0] == HERSHEY_PENUP) {
+                penup = true;
+                continue;
+            }
+
+            int16_t to_x = ox + v[0];
+            int16_t to_y = oy + v[1];
+            if (!penup) {
+                line(self, from_x, from_y, to_x, to_y, stroke->color, stroke->alpha);
+            }
+            from_x = to_x;
+            from_y = to_y;
+            penup = false;
+        }
+        return;
+    }
+
+    // bounding box of the glyph including the stroke
+    int min_x = INT16_MAX, min_y = INT16_MAX, max_x = INT16_MIN, max_y = INT16_MIN;
+    for (int i = 0; i < count; i++) {
+        if (v[i * 2] != HERSHEY_PENUP) {
+            min_x = MIN(min_x, v[i * 2]);
+            max_x = MAX(max_x, v[i * 2]);
+            min_y = MIN(min_y, v[i * 2 + 1]);
+            max_y = MAX(max_y, v[i * 2 + 1]);
+        }
+    }
+    if (min_x > max_x) {
+        return;
+    }
+
+    int pad = (int)stroke->radius + 2;
+    int bx = ox + min_x - pad;
+    int by = oy + min_y - pad;
+    int bw = max_x - min_x + 1 + pad * 2;
+    int bh = max_y - min_y + 1 + pad * 2;
+    if (bx >= self->width || by >= self->height || bx + bw <= 0 || by + bh <= 0) {
+        return;
+    }
+
+    size_t size = bw * bh;
+    if (size > stroke->coverage_size) {
+        m_free(stroke->coverage);
+        stroke->coverage = m_malloc(size);
+        stroke->coverage_size = size;
+    }
+    memset(stroke->coverage, 0, size);
+
+    int from_x = 0, from_y = 0;
+    bool penup = true;
+    for (int i = 0; i < count; i++, v += 2) {
+        if (v[0] == HERSHEY_PENUP) {
+            penup = true;
+            continue;
+        }
+
+        int to_x = ox + v[0] - bx;
+        int to_y = oy + v[1] - by;
+        if (!penup) {
+            stroke_capsule(stroke->coverage, bw, bh, from_x, from_y, to_x, to_y, stroke->radius, stroke->aa);
+        }
+        from_x = to_x;
+        from_y = to_y;
+        penup = false;
+    }
+    blend_coverage(self, bx, by, stroke->coverage, bw, bh, stroke->color, stroke->alpha);
+}
+
+//
+// hershey_draw: draw string s with a prescaled Hershey font, the pen position
+// is kept in fixed point so rotated text does not accumulate rounding error.
+//
+
+static void hershey_draw(s3lcd_obj_t *self, const s3lcd_hershey_obj_t *hershey, const char *s,
+    mp_int_t x, mp_int_t y, stroke_t *stroke) {
+
+    int32_t pos_x = x << HERSHEY_FRAC;
+    int32_t pos_y = y << HERSHEY_FRAC;
+    const int32_t round = 1 << (HERSHEY_FRAC - 1);
+    char c;
+
+    while ((c = *s++)) {
+        if (c >= HERSHEY_FIRST && c < HERSHEY_FIRST + HERSHEY_CHARS) {
+            const s3lcd_hershey_glyph_t *glyph = &hershey->glyphs[c - HERSHEY_FIRST];
+            stroke_glyph(self, stroke, &hershey->vertices[glyph->start * 2], glyph->count,
+                (pos_x + round) >> HERSHEY_FRAC, (pos_y + round) >> HERSHEY_FRAC);
+            pos_x += glyph->advance_x;
+            pos_y += glyph->advance_y;
+        }
+    }
+}
+
+///
+/// .draw(font, string|int, x, y, {color , scale, alpha, width=1, aa=False})
+/// Draw a string or a single character.
+/// required parameters:
+/// -- font: a font module or Hershey object
+/// -- string: a string or a single character
+/// -- x: x coordinate of the top left corner of the string
+/// -- y: y coordinate of the top left corner of the string
+/// optional parameters:
+/// -- color defaults to WHITE
+/// -- scale defaults to 1, ignored for Hershey objects which are prescaled
+/// -- alpha defaults to 255
+/// -- width: stroke width in pixels, defaults to 1
+/// -- aa: True to anti-alias the strokes
+///
+
+static mp_obj_t s3lcd_draw(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_font, ARG_s, ARG_x, ARG_y, ARG_color, ARG_scale, ARG_alpha, ARG_width, ARG_aa };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_s, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_x, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_y, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_color, MP_ARG_INT, {.u_int = WHITE}},
+        {MP_QSTR_scale, MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_alpha, MP_ARG_INT, {.u_int = 255}},
+        {MP_QSTR_width, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_aa, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    frame_buffer_required(self);
+    char single_char_s[] = {0, 0};
+    const char *s;
+
+    if (mp_obj_is_int(args[ARG_s].u_obj)) {
+        mp_int_t c = mp_obj_get_int(args[ARG_s].u_obj);
+        single_char_s[0] = c & 0xff;
+        s = single_char_s;
+    } else {
+        s = mp_obj_str_get_str(args[ARG_s].u_obj);
+    }
+
+    mp_int_t x = args[ARG_x].u_int;
+    mp_int_t y = args[ARG_y].u_int;
+
+    mp_float_t scale = 1.0;
+    mp_obj_t scale_obj = args[ARG_scale].u_obj;
+    if (scale_obj != MP_OBJ_NULL) {
+        if (mp_obj_is_float(scale_obj)) {
+            scale = mp_obj_float_get(scale_obj);
+        }
+        if (mp_obj_is_int(scale_obj)) {
+            scale = (mp_float_t)mp_obj_get_int(scale_obj);
+        }
+    }
+
+    mp_float_t width = 1.0;
+    if (args[ARG_width].u_obj != MP_OBJ_NULL) {
+        width = mp_obj_get_float(args[ARG_width].u_obj);
+    }
+
+    stroke_t stroke = {
+        .color = args[ARG_color].u_int,
+        .alpha = args[ARG_alpha].u_int,
+        .thick = width > 1 || args[ARG_aa].u_bool,
+        .aa = args[ARG_aa].u_bool,
+        .radius = width / 2,
+        .coverage = NULL,
+        .coverage_size = 0,
+    };
+
+    if (mp_obj_is_type(args[ARG_font].u_obj, &s3lcd_hershey_type)) {
+        hershey_draw(self, MP_OBJ_TO_PTR(args[ARG_font].u_obj), s, x, y, &stroke);
+    } else {
+        mp_obj_module_t *hershey = MP_OBJ_TO_PTR(args[ARG_font].u_obj);
+        mp_obj_dict_t *dict = MP_OBJ_TO_PTR(hershey->globals);
+        mp_obj_t *index_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_INDEX));
+        mp_buffer_info_t index_bufinfo;
+        mp_get_buffer_raise(index_data_buff, &index_bufinfo, MP_BUFFER_READ);
+        uint8_t *index = index_bufinfo.buf;
+
+        mp_obj_t *font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));
+        mp_buffer_info_t font_bufinfo;
+        mp_get_buffer_raise(font_data_buff, &font_bufinfo, MP_BUFFER_READ);
+        int8_t *font = font_bufinfo.buf;
+
+        int16_t vertices[INT8_MAX * 2];
+        int16_t pos_x = x;
+        char c;
+        int16_t ii;
+
+        while ((c = *s++)) {
+            if (c >= 32 && c <= 127) {
+                ii = (c - 32) * 2;
+
+                int16_t offset = index[ii] | (index[ii + 1] << 8);
+                int16_t length = font[offset++];
+                int16_t left = s3lcd_hershey_scale(scale, font[offset]);
+                int16_t width = s3lcd_hershey_width(&font[offset], scale);
+                offset += 2;
+
+                for (int16_t i = 0; i < length; i++) {
+                    if (font[offset] == ' ') {
+                        offset += 2;
+                        vertices[i * 2] = HERSHEY_PENUP;
+                        continue;
+                    }
+
+                    vertices[i * 2] = s3lcd_hershey_scale(scale, font[offset++]) - left;
+                    vertices[i * 2 + 1] = s3lcd_hershey_scale(scale, font[offset++]);
+                }
+                stroke_glyph(self, &stroke, vertices, length, pos_x, y);
+                pos_x += width;
+            }
+        }
+    }
+
+    if (stroke.coverage) {
+        m_free(stroke.coverage);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_draw_obj, 5, s3lcd_draw);
+
+///
+/// .draw_len(font, string|int {, scale})
 /// Returns the width of the string in pixels if drawn with the given font and scale (default 1).
 /// required parameters:
-/// -- font: a font module
+/// -- font: a font module or Hershey object
 /// -- string: a string or a single character
 /// optional parameters:
-/// -- scale: scale of the string (default 1)
+/// -- scale: scale of the string (default 1), ignored for Hershey objects
 ///
 
 static mp_obj_t s3lcd_draw_len(size_t n_args, const mp_obj_t *args) {
@@ -745,6 +1479,18 @@ static mp_obj_t s3lcd_draw_len(size_t n_args, const mp_obj_t *args) {
         s = mp_obj_str_get_str(args[2]);
     }
 
+    if (mp_obj_is_type(args[1], &s3lcd_hershey_type)) {
+        s3lcd_hershey_obj_t *prescaled = MP_OBJ_TO_PTR(args[1]);
+        mp_int_t print_width = 0;
+        char c;
+        while ((c = *s++)) {
+            if (c >= HERSHEY_FIRST && c < HERSHEY_FIRST + HERSHEY_CHARS) {
+                print_width += prescaled->glyphs[c - HERSHEY_FIRST].width;
+            }
+        }
+        return mp_obj_new_int(print_width);
+    }
+
     mp_float_t scale = 1.0;
     if (n_args > 3) {
         if (mp_obj_is_float(args[3])) {
@@ -766,7 +1512,7 @@ static mp_obj_t s3lcd_draw_len(size_t n_args, const mp_obj_t *args) {
     mp_get_buffer_raise(font_data_buff, &font_bufinfo, MP_BUFFER_READ);
     int8_t *font = font_bufinfo.buf;
 
-    int16_t print_width = 0;
+    mp_int_t print_width = 0;
     char c;
     int16_t ii;
 
@@ -775,31 +1521,233 @@ static mp_obj_t s3lcd_draw_len(size_t n_args, const mp_obj_t *args) {
             ii = (c - 32) * 2;
 
             int16_t offset = (index[ii] | (index[ii + 1] << 8)) + 1;
-            int16_t left = font[offset++] - 0x52;
-            int16_t right = font[offset++] - 0x52;
-            int16_t width = right - left;
-            print_width += width;
+            print_width += s3lcd_hershey_width(&font[offset], scale);
         }
     }
-    return mp_obj_new_int((int)(print_width * scale + 0.5));
+    return mp_obj_new_int(print_width);
 }
 static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_draw_len_obj, 3, 4, s3lcd_draw_len);
 
-static uint32_t bs_bit = 0;
-uint8_t *bitmap_data = NULL;
+//
+// Packed pixel unpacking
+//
+// Font glyphs and bitmap modules store their pixels as a big-endian bitstream
+// of bpp bits per pixel. The unpack tables expand a whole source byte into
+// its 8 / bpp pixel indexes so the 1, 2 and 4 bpp paths cost one lookup per
+// source byte instead of a shift and mask per bit.
+//
+
+static uint8_t unpack_lut_1bpp[256][8];
+static uint8_t unpack_lut_2bpp[256][4];
+static uint8_t unpack_lut_4bpp[256][2];
+static bool unpack_lut_ready = false;
+
+static void unpack_lut_init(void) {
+    if (unpack_lut_ready) {
+        return;
+    }
+
+    for (int v = 0; v < 256; v++) {
+        for (int i = 0; i < 8; i++) {
+            unpack_lut_1bpp[v][i] = (v >> (7 - i)) & 0x01;
+        }
+        for (int i = 0; i < 4; i++) {
+            unpack_lut_2bpp[v][i] = (v >> (6 - i * 2)) & 0x03;
+        }
+        for (int i = 0; i < 2; i++) {
+            unpack_lut_4bpp[v][i] = (v >> (4 - i * 4)) & 0x0f;
+        }
+    }
+    unpack_lut_ready = true;
+}
 
-static uint8_t get_color(uint8_t bpp) {
+static uint8_t get_color(bitstream_t *bs, uint8_t bpp) {
     uint8_t color = 0;
     int i;
 
     for (i = 0; i < bpp; i++) {
         color <<= 1;
-        color |= (bitmap_data[bs_bit / 8] & 1 << (7 - (bs_bit % 8))) > 0;
-        bs_bit++;
+        color |= (bs->data[bs->bit / 8] & 1 << (7 - (bs->bit % 8))) > 0;
+        bs->bit++;
     }
     return color;
 }
 
+//
+// unpack_span: expand count pixels from the bitstream directly into dst,
+// mapping each index through palette. Pixels with the transparent index are
+// skipped, pass -1 to draw every pixel. alpha < 255 blends with dst.
+//
+
+static void unpack_span(bitstream_t *bs, uint8_t bpp, uint16_t *dst, int count,
+    const uint16_t *palette, int transparent, uint8_t alpha) {
+
+    const uint8_t *lut = NULL;
+    uint8_t ppb = 1;                        // pixels per byte
+
+    switch (bpp) {
+        case 1:
+            lut = &unpack_lut_1bpp[0][0];
+            ppb = 8;
+            break;
+        case 2:
+            lut = &unpack_lut_2bpp[0][0];
+            ppb = 4;
+            break;
+        case 4:
+            lut = &unpack_lut_4bpp[0][0];
+            ppb = 2;
+            break;
+    }
+
+    while (count > 0) {
+        const uint8_t *idx;
+        uint8_t single;
+        int run;
+
+        if (lut) {
+            uint8_t pos = (bs->bit & 7) / bpp;
+            idx = lut + bs->data[bs->bit >> 3] * ppb + pos;
+            run = ppb - pos;
+            if (run > count) {
+                run = count;
+            }
+            bs->bit += run * bpp;
+        } else if (bpp == 8 && (bs->bit & 7) == 0) {
+            idx = bs->data + (bs->bit >> 3);
+            run = count;
+            bs->bit += run * 8;
+        } else {
+            single = get_color(bs, bpp);
+            idx = &single;
+            run = 1;
+        }
+        count -= run;
+
+        if (alpha == 255) {
+            if (transparent < 0) {
+                while (run--) {
+                    *dst++ = palette[*idx++];
+                }
+            } else {
+                while (run--) {
+                    uint8_t i = *idx++;
+                    if (i != transparent) {
+                        *dst = palette[i];
+                    }
+                    dst++;
+                }
+            }
+        } else {
+            while (run--) {
+                uint8_t i = *idx++;
+                if (i != transparent) {
+                    *dst = alpha_blend_565(palette[i], *dst, alpha);
+                }
+                dst++;
+            }
+        }
+    }
+}
+
+//
+// unpack_indexes: expand count pixels from the bitstream into one pixel index
+// per byte.
+//
+
+static void unpack_indexes(bitstream_t *bs, uint8_t bpp, uint8_t *dst, int count) {
+    const uint8_t *lut = NULL;
+    uint8_t ppb = 1;
+
+    switch (bpp) {
+        case 1:
+            lut = &unpack_lut_1bpp[0][0];
+            ppb = 8;
+            break;
+        case 2:
+            lut = &unpack_lut_2bpp[0][0];
+            ppb = 4;
+            break;
+        case 4:
+            lut = &unpack_lut_4bpp[0][0];
+            ppb = 2;
+            break;
+    }
+
+    if (lut == NULL) {
+        while (count--) {
+            *dst++ = get_color(bs, bpp);
+        }
+        return;
+    }
+
+    while (count > 0) {
+        uint8_t pos = (bs->bit & 7) / bpp;
+        const uint8_t *idx = lut + bs->data[bs->bit >> 3] * ppb + pos;
+        int run = ppb - pos;
+        if (run > count) {
+            run = count;
+        }
+        bs->bit += run * bpp;
+        count -= run;
+        while (run--) {
+            *dst++ = *idx++;
+        }
+    }
+}
+
+//
+// index_span: map count pixel indexes from src through palette into dst.
+// Arguments are the same as unpack_span.
+//
+
+static void index_span(const uint8_t *src, uint16_t *dst, int count,
+    const uint16_t *palette, int transparent, uint8_t alpha) {
+
+    if (alpha == 255) {
+        if (transparent < 0) {
+            while (count--) {
+                *dst++ = palette[*src++];
+            }
+        } else {
+            while (count--) {
+                uint8_t i = *src++;
+                if (i != transparent) {
+                    *dst = palette[i];
+                }
+                dst++;
+            }
+        }
+    } else {
+        while (count--) {
+            uint8_t i = *src++;
+            if (i != transparent) {
+                *dst = alpha_blend_565(palette[i], *dst, alpha);
+            }
+            dst++;
+        }
+    }
+}
+
+//
+// coverage_span: blend color over count pixels of dst, using each pixel index
+// from src as a position in the coverage table of 0-255 blend weights.
+//
+
+static void coverage_span(const uint8_t *src, uint16_t *dst, int count,
+    uint16_t color, const uint8_t *coverage) {
+
+    while (count--) {
+        uint8_t a = coverage[*src++];
+        if (a == 255) {
+            *dst = color;
+        } else if (a) {
+            *dst = alpha_blend_565(color, *dst, a);
+        }
+        dst++;
+    }
+}
+
 static mp_obj_t dict_lookup(mp_obj_t self_in, mp_obj_t index) {
     mp_obj_dict_t *self = MP_OBJ_TO_PTR(self_in);
     mp_map_elem_t *elem = mp_map_lookup(&self->map, index, MP_MAP_LOOKUP);
@@ -809,1791 +1757,4649 @@ static mp_obj_t dict_lookup(mp_obj_t self_in, mp_obj_t index) {
     return mp_const_none;
 }
 
-///
-/// .write_len(font, string)
-/// return the width in pixels of the string or character if written with a font.
-/// required parameters:
-/// -- font: a font module
-/// -- string: a string or a single character
-///
+//
+// cached_glyph: return the decoded glyph for codepoint from the glyph cache,
+// decoding and adding it on a miss. Returns NULL if the glyph does not fit in
+// the cache.
+//
 
-static mp_obj_t s3lcd_write_len(size_t n_args, const mp_obj_t *args) {
-    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
-    mp_obj_t widths_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTHS));
-    mp_buffer_info_t widths_bufinfo;
-    mp_get_buffer_raise(widths_data_buff, &widths_bufinfo, MP_BUFFER_READ);
-    const uint8_t *widths_data = widths_bufinfo.buf;
+static s3lcd_glyph_t *cached_glyph(s3lcd_glyph_cache_t *cache, s3lcd_font_obj_t *font, uint32_t codepoint, int char_index) {
+    s3lcd_glyph_t *glyph = s3lcd_glyph_cache_find(cache, font->module, codepoint);
+    if (glyph == NULL) {
+        int bearing;
+        uint8_t width = s3lcd_font_box(font, char_index, &bearing);
+        glyph = s3lcd_glyph_cache_add(cache, font->module, codepoint, width, font->height);
+        if (glyph) {
+            bitstream_t bs;
+            s3lcd_font_bitmap(font, char_index, &bs);
+            unpack_indexes(&bs, font->bpp, glyph->pixels, width * font->height);
+        }
+    }
+    return glyph;
+}
 
-    uint16_t print_width = 0;
+//
+// text_style_t: colors of a write() call resolved for the font's bpp.
+// Anti-aliased text over a transparent background blends each pixel with the
+// frame buffer using its coverage, otherwise every pixel index maps to a
+// palette color. Without aa index 0 is background and any other foreground.
+//
 
-    mp_obj_t map_obj = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAP));
-    GET_STR_DATA_LEN(map_obj, map_data, map_len);
-    GET_STR_DATA_LEN(args[2], str_data, str_len);
-    const byte *s = str_data, *top = str_data + str_len;
+typedef struct _text_style_t {
+    bool blend;                             // blend fg using coverage
+    uint16_t fg;                            // foreground color
+    uint8_t alpha;                          // alpha of palette colors
+    int transparent;                        // palette index to skip or -1
+    uint8_t coverage[256];                  // blend weight of each pixel index
+    uint16_t palette[256];                  // color of each pixel index
+} text_style_t;
+
+static void text_style_init(text_style_t *style, uint8_t bpp, mp_int_t fg_color, mp_int_t bg_color, mp_int_t alpha, bool aa) {
+    const int levels = (1 << bpp) - 1;
+
+    style->blend = aa && bg_color == -1;
+    style->fg = fg_color;
+    style->alpha = alpha;
+    style->transparent = -1;
+
+    if (style->blend) {
+        for (int i = 0; i <= levels; i++) {
+            style->coverage[i] = i * alpha / levels;
+        }
+    } else if (aa) {
+        for (int i = 0; i <= levels; i++) {
+            style->palette[i] = alpha_blend_565(fg_color, bg_color, i * 255 / levels);
+        }
+    } else {
+        style->palette[0] = bg_color;
+        for (int i = 1; i <= levels; i++) {
+            style->palette[i] = fg_color;
+        }
+        style->transparent = (bg_color == -1) ? 0 : -1;
+    }
+}
 
-    while (s < top) {
-        unichar ch;
-        ch = utf8_get_char(s);
-        s = utf8_next_char(s);
+//
+// draw_glyph: draw glyph char_index of font with its pen position at x, y,
+// clipped to the frame buffer. Glyphs entirely off the frame buffer are
+// rejected before they are decoded, and the bitstream skips clipped rows and
+// columns arithmetically. A TrueType glyph's bitmap may be narrower than its
+// advance or overhang it; with an opaque background the advance is filled
+// first and only the set pixels of the bitmap are drawn over it.
+//
+
+static void draw_glyph(s3lcd_obj_t *self, s3lcd_font_obj_t *font, const text_style_t *style,
+    unichar ch, int char_index, int x, int y) {
 
-        const byte *map_s = map_data, *map_top = map_data + map_len;
-        uint16_t char_index = 0;
+    const int height = font->height;
+    int bearing;
+    const int width = s3lcd_font_box(font, char_index, &bearing);
+    int transparent = style->transparent;
+    if (font->ttf && transparent < 0 && !style->blend) {
+        fill_rect_clipped(self, x, y, s3lcd_font_width(font, char_index), height, style->palette[0], style->alpha);
+        transparent = 0;
+    }
+    x += bearing;
+
+    // visible columns and rows of the glyph
+    int left = (x < 0) ? -x : 0;
+    int top = (y < 0) ? -y : 0;
+    int right = (x + width > self->width) ? self->width - x : width;
+    int bottom = (y + height > self->height) ? self->height - y : height;
+    if (left >= right || top >= bottom) {
+        return;
+    }
 
-        while (map_s < map_top) {
-            unichar map_ch;
-            map_ch = utf8_get_char(map_s);
-            map_s = utf8_next_char(map_s);
+    const int span = right - left;
+    s3lcd_glyph_t *glyph = NULL;
+    if (self->glyph_cache) {
+        glyph = cached_glyph(self->glyph_cache, font, ch, char_index);
+    }
 
-            if (ch == map_ch) {
-                print_width += widths_data[char_index];
-                break;
+    uint16_t *b = &(self->frame_buffer)[(x + left) + (y + top) * self->width];
+    if (glyph) {
+        const uint8_t *src = glyph->pixels + top * width + left;
+        for (int yy = top; yy < bottom; yy++) {
+            if (style->blend) {
+                coverage_span(src, b, span, style->fg, style->coverage);
+            } else {
+                index_span(src, b, span, style->palette, transparent, style->alpha);
+            }
+            src += width;
+            b += self->width;
+        }
+    } else {
+        const uint8_t bpp = font->bpp;
+        uint8_t row[256];
+        bitstream_t bs;
+        s3lcd_font_bitmap(font, char_index, &bs);
+        bs.bit += (top * width + left) * bpp;
+        for (int yy = top; yy < bottom; yy++) {
+            if (style->blend) {
+                unpack_indexes(&bs, bpp, row, span);
+                coverage_span(row, b, span, style->fg, style->coverage);
+            } else {
+                unpack_span(&bs, bpp, b, span, style->palette, transparent, style->alpha);
             }
-            char_index++;
+            bs.bit += (width - span) * bpp;
+            b += self->width;
         }
     }
-    return mp_obj_new_int(print_width);
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_write_len_obj, 3, 3, s3lcd_write_len);
 
-///
-///	.write(font, s, x, y {, fg, bg, alpha})
-/// write a string or character to the display.
-/// required parameters:
-/// -- font: a font module
-/// -- s: a string or a single character
-/// -- x: the x position of the string or character
-/// -- y: the y position of the string or character
-/// optional parameters:
-/// -- fg: the foreground color of the string or character
-/// -- bg: the background color of the string or character
-/// -- alpha: the alpha value of the string or character
-///
+//
+// Text outline and drop shadow
+//
+// Text with an outline or shadow is drawn from a coverage mask of the whole
+// string. The mask is dilated once for the outline, and every pixel is then
+// composited in one pass: shadow, then outline, then the text itself. The
+// mask has pad pixels on every side so the dilation and the shadow offset
+// never read outside it.
+//
 
-static mp_obj_t s3lcd_write(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
+#define TEXT_SHADOW_MAX 16                  // largest shadow offset in pixels
 
-    mp_int_t x = mp_obj_get_int(args[3]);
-    mp_int_t y = mp_obj_get_int(args[4]);
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, fg_color, WHITE)
-    OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, bg_color, BLACK)
-    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, alpha, 255)
+typedef struct _text_mask_t {
+    uint8_t *fill;                          // coverage of the text
+    uint8_t *outline;                       // fill dilated by one pixel, or NULL
+    int x, y;                               // frame buffer position of the first unpadded pixel
+    int width, height;                      // size without padding
+    int pad;                                // pixels of padding on each side
+    int stride;                             // bytes per mask row
+} text_mask_t;
 
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
-    const uint8_t bpp = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BPP)));
-    const uint8_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
-    const uint8_t offset_width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSET_WIDTH)));
+static inline uint8_t *text_mask_at(const text_mask_t *mask, uint8_t *data, int x, int y) {
+    return data + (y - mask->y + mask->pad) * mask->stride + (x - mask->x + mask->pad);
+}
 
-    mp_obj_t widths_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTHS));
-    mp_buffer_info_t widths_bufinfo;
-    mp_get_buffer_raise(widths_data_buff, &widths_bufinfo, MP_BUFFER_READ);
-    const uint8_t *widths_data = widths_bufinfo.buf;
+//
+// text_mask_init: allocate a mask for text in the box x, y, w, h, clipped to
+// the part of the box that can affect the frame buffer. Returns false if
+// nothing would be drawn.
+//
 
-    mp_obj_t offsets_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSETS));
-    mp_buffer_info_t offsets_bufinfo;
-    mp_get_buffer_raise(offsets_data_buff, &offsets_bufinfo, MP_BUFFER_READ);
-    const uint8_t *offsets_data = offsets_bufinfo.buf;
+static bool text_mask_init(text_mask_t *mask, s3lcd_obj_t *self, int margin, int offset,
+    int x, int y, int w, int h) {
 
-    mp_obj_t bitmaps_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAPS));
-    mp_buffer_info_t bitmaps_bufinfo;
-    mp_get_buffer_raise(bitmaps_data_buff, &bitmaps_bufinfo, MP_BUFFER_READ);
-    bitmap_data = bitmaps_bufinfo.buf;
+    int left = (x < -margin) ? -margin : x;
+    int top = (y < -margin) ? -margin : y;
+    int right = (x + w > self->width + margin) ? self->width + margin : x + w;
+    int bottom = (y + h > self->height + margin) ? self->height + margin : y + h;
+    if (left >= right || top >= bottom) {
+        return false;
+    }
 
-    uint16_t print_width = 0;
-    mp_obj_t map_obj = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAP));
-    GET_STR_DATA_LEN(map_obj, map_data, map_len);
-    GET_STR_DATA_LEN(args[2], str_data, str_len);
-    const byte *s = str_data, *top = str_data + str_len;
-    while (s < top) {
-        unichar ch;
-        ch = utf8_get_char(s);
-        s = utf8_next_char(s);
+    mask->x = left;
+    mask->y = top;
+    mask->width = right - left;
+    mask->height = bottom - top;
+    mask->pad = margin + offset + 1;
+    mask->stride = mask->width + mask->pad * 2;
+
+    size_t size = mask->stride * (mask->height + mask->pad * 2);
+    mask->fill = m_malloc(size);
+    memset(mask->fill, 0, size);
+    mask->outline = NULL;
+    return true;
+}
 
-        const byte *map_s = map_data, *map_top = map_data + map_len;
-        uint16_t char_index = 0;
-
-        while (map_s < map_top) {
-            unichar map_ch;
-            map_ch = utf8_get_char(map_s);
-            map_s = utf8_next_char(map_s);
-
-            if (ch == map_ch) {
-                uint8_t width = widths_data[char_index];
-
-                bs_bit = 0;
-                switch (offset_width) {
-                    case 1:
-                        bs_bit = offsets_data[char_index * offset_width];
-                        break;
-
-                    case 2:
-                        bs_bit = (offsets_data[char_index * offset_width] << 8) +
-                            (offsets_data[char_index * offset_width + 1]);
-                        break;
-
-                    case 3:
-                        bs_bit = (offsets_data[char_index * offset_width] << 16) +
-                            (offsets_data[char_index * offset_width + 1] << 8) +
-                            (offsets_data[char_index * offset_width + 2]);
-                        break;
-                }
+static void text_mask_free(text_mask_t *mask) {
+    m_free(mask->outline);
+    m_free(mask->fill);
+}
 
-                for (int yy = 0; yy < height; yy++) {
-                    uint16_t *b = &(self->frame_buffer)[x + ((y + yy) * self->width)];
-                    for (int xx = 0; xx < width; xx++) {
-                        if (get_color(bpp)) {
-                            if (alpha == 255) {
-                                *b = fg_color;
-                            } else {
-                                *b = alpha_blend_565(*b, fg_color, alpha);
-                            }
-                        } else {
-                            if (bg_color != -1) {
-                                if (alpha == 255) {
-                                    *b = bg_color;
-                                } else {
-                                    *b = alpha_blend_565(*b, bg_color, alpha);
-                                }
-                            }
-                        }
-                        b++;
-                    }
-                }
+//
+// text_mask_glyph: add a width by height glyph at x, y to the mask, mapping
+// each pixel index through level and keeping the larger coverage where
+// glyphs overlap. The glyph is read from pixels, one index per byte, or from
+// the bitstream bs if pixels is NULL.
+//
 
-                x += width;
-                print_width += width;
-                break;
-            }
-            char_index++;
-        }
+static void text_mask_glyph(text_mask_t *mask, const uint8_t *pixels, bitstream_t *bs, uint8_t bpp,
+    const uint8_t *level, int x, int y, int width, int height) {
+
+    int left = (x < mask->x) ? mask->x - x : 0;
+    int top = (y < mask->y) ? mask->y - y : 0;
+    int right = (x + width > mask->x + mask->width) ? mask->x + mask->width - x : width;
+    int bottom = (y + height > mask->y + mask->height) ? mask->y + mask->height - y : height;
+    if (left >= right || top >= bottom) {
+        return;
     }
-    return mp_obj_new_int(print_width);
-}
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_write_obj, 5, 8, s3lcd_write);
 
-///
-/// .bitmap(bitmap, x, y {, alpha})
-/// required parameters:
-/// -- bitmap: a tuple of (width, height, data)
-/// -- x: x position
-/// -- y: y position
-/// optional parameters:
-/// -- alpha: alpha value (0-255)
-///
+    const int span = right - left;
+    uint8_t indexes[256];
+    if (bs) {
+        bs->bit += (top * width + left) * bpp;
+    }
+    for (int row = top; row < bottom; row++) {
+        uint8_t *dst = text_mask_at(mask, mask->fill, x + left, y + row);
+        const uint8_t *src = indexes;
+        if (pixels) {
+            src = pixels + row * width + left;
+        } else {
+            unpack_indexes(bs, bpp, indexes, span);
+            bs->bit += (width - span) * bpp;
+        }
+        for (int i = 0; i < span; i++) {
+            uint8_t c = level[src[i]];
+            if (c > dst[i]) {
+                dst[i] = c;
+            }
+        }
+    }
+}
 
-static mp_obj_t s3lcd_bitmap_from_tuple(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_obj_t *bitmap_tuple = NULL;
-    size_t bitmap_tuple_len = 0;
-    mp_obj_tuple_get(args[1], &bitmap_tuple_len, &bitmap_tuple);
-    if (bitmap_tuple_len != 3) {
-        mp_raise_ValueError(MP_ERROR_TEXT("bitmap tuple must have 3 elements"));
+//
+// text_mask_draw: composite the shadow, outline and fill of the mask over the
+// frame buffer. The box x, y, w, h is filled with bg unless bg is -1, and
+// colors of -1 are not drawn.
+//
+
+static void text_mask_draw(s3lcd_obj_t *self, text_mask_t *mask, int margin, int offset,
+    int x, int y, int w, int h, mp_int_t fg, mp_int_t bg, mp_int_t outline, mp_int_t shadow, uint8_t alpha) {
+
+    // dilate the fill by one pixel, leaving the outermost ring of padding
+    if (outline != -1) {
+        size_t size = mask->stride * (mask->height + mask->pad * 2);
+        mask->outline = m_malloc(size);
+        memset(mask->outline, 0, size);
+        for (int row = 1; row < mask->height + mask->pad * 2 - 1; row++) {
+            const uint8_t *above = mask->fill + (row - 1) * mask->stride;
+            const uint8_t *here = above + mask->stride;
+            const uint8_t *below = here + mask->stride;
+            uint8_t *dst = mask->outline + row * mask->stride;
+            for (int col = 1; col < mask->stride - 1; col++) {
+                uint8_t v = 0;
+                for (int i = col - 1; i <= col + 1; i++) {
+                    v = (above[i] > v) ? above[i] : v;
+                    v = (here[i] > v) ? here[i] : v;
+                    v = (below[i] > v) ? below[i] : v;
+                }
+                dst[col] = v;
+            }
+        }
     }
 
-    mp_int_t x = mp_obj_get_int(args[2]);
-    mp_int_t y = mp_obj_get_int(args[3]);
+    // the shadow is cast by the outlined text
+    const uint8_t *shadow_src = (outline != -1) ? mask->outline : mask->fill;
+
+    int left = (x - margin < 0) ? 0 : x - margin;
+    int top = (y - margin < 0) ? 0 : y - margin;
+    int right = (x + w + margin > self->width) ? self->width : x + w + margin;
+    int bottom = (y + h + margin > self->height) ? self->height : y + h + margin;
+
+    for (int row = top; row < bottom; row++) {
+        uint16_t *b = &self->frame_buffer[row * self->width + left];
+        const uint8_t *fill = text_mask_at(mask, mask->fill, left, row);
+        const uint8_t *edge = (outline != -1) ? text_mask_at(mask, mask->outline, left, row) : NULL;
+        const uint8_t *dark = text_mask_at(mask, (uint8_t *)shadow_src, left - offset, row - offset);
+        bool in_rows = row >= y && row < y + h;
+
+        for (int col = left; col < right; col++, b++, fill++, dark++) {
+            uint16_t color = *b;
+            if (bg != -1 && in_rows && col >= x && col < x + w) {
+                color = (alpha == 255) ? bg : alpha_blend_565(bg, color, alpha);
+            }
+            if (shadow != -1 && *dark) {
+                color = alpha_blend_565(shadow, color, *dark * alpha / 255);
+            }
+            if (edge) {
+                if (*edge) {
+                    color = alpha_blend_565(outline, color, *edge * alpha / 255);
+                }
+                edge++;
+            }
+            if (fg != -1 && *fill) {
+                color = alpha_blend_565(fg, color, *fill * alpha / 255);
+            }
+            *b = color;
+        }
+    }
+}
 
-    mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(bitmap_tuple[0], &bufinfo, MP_BUFFER_READ);
+//
+// effect_color: return the color of an outline or shadow argument, or -1 if
+// it was not given or is None.
+//
 
-    mp_int_t width = mp_obj_get_int(bitmap_tuple[1]);
-    mp_int_t height = mp_obj_get_int(bitmap_tuple[2]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, alpha, 255)
+static mp_int_t effect_color(mp_obj_t color) {
+    return (color == MP_OBJ_NULL || color == mp_const_none) ? -1 : mp_obj_get_int(color);
+}
 
-    if (bufinfo.len < width * height * 2) {
-        mp_raise_ValueError(MP_ERROR_TEXT("bitmap size too small for width and height"));
-    }
-    uint16_t *s = (uint16_t *)bufinfo.buf;
-    uint16_t *d = self->frame_buffer + (y * self->width) + x;
-    if (alpha == 255) {
-        COPY_TO_BUFFER(self, s, d, width, height)
-    } else {
-        BLEND_TO_BUFFER(self, s, d, width, height, alpha)
+static mp_int_t effect_offset(mp_int_t offset) {
+    if (offset < 1 || offset > TEXT_SHADOW_MAX) {
+        mp_raise_ValueError(MP_ERROR_TEXT("shadow_offset must be 1 to 16"));
     }
-    return mp_const_none;
+    return offset;
 }
 
-///
-/// .bitmap(bitmap, x, y {, alpha, index})
-/// bitmap: a bitmap module created by imgtobitmap.py utility
-/// required parameters:
-/// -- x: x position
-/// -- y: y position
-/// optional parameters:
-/// -- index: index of the character in the map
-/// -- alpha: alpha value (0-255)
-///
-
-static mp_obj_t s3lcd_bitmap_from_module(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_obj_module_t *bitmap = MP_OBJ_TO_PTR(args[1]);
-    mp_int_t x = mp_obj_get_int(args[2]);
-    mp_int_t y = mp_obj_get_int(args[3]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, idx, 0)
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+//
+// write_effects: write() with an outline or shadow, returns the width of the
+// text in pixels.
+//
 
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(bitmap->globals);
-    const uint16_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
-    const uint16_t width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTH)));
-    uint16_t bitmaps = 0;
-    const uint8_t bpp = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BPP)));
-    mp_obj_t *palette_arg = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_PALETTE));
-    mp_obj_t *palette = NULL;
-    size_t palette_len = 0;
+static mp_int_t write_effects(s3lcd_obj_t *self, s3lcd_font_obj_t *font, const byte *s, const byte *top,
+    mp_int_t x, mp_int_t y, mp_int_t fg, mp_int_t bg, mp_int_t alpha, bool aa,
+    mp_int_t outline, mp_int_t shadow, mp_int_t offset) {
 
-    mp_map_elem_t *elem = dict_lookup(bitmap->globals, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAPS));
-    if (elem) {
-        bitmaps = mp_obj_get_int(elem);
+    mp_int_t print_width = 0;
+    for (const byte *p = s; p < top; p = utf8_next_char(p)) {
+        int char_index = s3lcd_font_glyph(font, utf8_get_char(p));
+        if (char_index >= 0) {
+            print_width += s3lcd_font_width(font, char_index);
+        }
     }
 
-    mp_obj_get_array(palette_arg, &palette_len, &palette);
-
-    mp_obj_t *bitmap_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAP));
-    mp_buffer_info_t bufinfo;
+    if (shadow == -1) {
+        offset = 0;
+    }
+    int margin = ((outline != -1) ? 1 : 0) + offset;
+    text_mask_t mask;
+    if (!text_mask_init(&mask, self, margin, offset, x, y, print_width, font->height)) {
+        return print_width;
+    }
 
-    mp_get_buffer_raise(bitmap_data_buff, &bufinfo, MP_BUFFER_READ);
-    bitmap_data = bufinfo.buf;
+    // pixel indexes are coverage when anti-aliased, otherwise any set pixel is covered
+    const int levels = (1 << font->bpp) - 1;
+    uint8_t level[256];
+    for (int i = 0; i <= levels; i++) {
+        level[i] = aa ? i * 255 / levels : (i ? 255 : 0);
+    }
 
-    bs_bit = 0;
-    if (bitmaps) {
-        if (idx < bitmaps) {
-            bs_bit = height * width * bpp * idx;
-        } else {
-            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("index out of range"));
+    mp_int_t gx = x;
+    while (s < top) {
+        unichar ch = utf8_get_char(s);
+        s = utf8_next_char(s);
+        int char_index = s3lcd_font_glyph(font, ch);
+        if (char_index < 0) {
+            continue;
         }
-    }
 
-    for (int yy = 0; yy < height; yy++) {
-        uint16_t *b = self->frame_buffer + (yy + y) * self->width + x;
-        for (int xx = 0; xx < width; xx++) {
-            int color_idx = get_color(bpp);
-            uint16_t color = mp_obj_get_int(palette[color_idx]);
-            if (alpha != 255) {
-                color = alpha_blend_565(color, *b, alpha);
+        int bearing;
+        uint8_t width = s3lcd_font_box(font, char_index, &bearing);
+        int bx = gx + bearing;
+        if (bx + width > mask.x && bx < mask.x + mask.width) {
+            s3lcd_glyph_t *glyph = NULL;
+            if (self->glyph_cache) {
+                glyph = cached_glyph(self->glyph_cache, font, ch, char_index);
+            }
+            if (glyph) {
+                text_mask_glyph(&mask, glyph->pixels, NULL, font->bpp, level, bx, y, width, font->height);
+            } else {
+                bitstream_t bs;
+                s3lcd_font_bitmap(font, char_index, &bs);
+                text_mask_glyph(&mask, NULL, &bs, font->bpp, level, bx, y, width, font->height);
             }
-            *b++ = _swap_bytes(color);
         }
+        gx += s3lcd_font_width(font, char_index);
     }
-    return mp_const_none;
+
+    text_mask_draw(self, &mask, margin, offset, x, y, print_width, font->height, fg, bg, outline, shadow, alpha);
+    text_mask_free(&mask);
+    return print_width;
 }
 
-static mp_obj_t s3lcd_bitmap(size_t n_args, const mp_obj_t *args) {
+///
+/// .write_len(font, string)
+/// return the width in pixels of the string or character if written with a font.
+/// required parameters:
+/// -- font: a font module or Font object
+/// -- string: a string or a single character
+///
 
-    if (mp_obj_is_type(args[1], &mp_type_tuple)) {
-        return s3lcd_bitmap_from_tuple(n_args, args);
-    } else {
-        if (mp_obj_is_type(args[1], &mp_type_module)) {
-            return s3lcd_bitmap_from_module(n_args, args);
+static mp_obj_t s3lcd_write_len(size_t n_args, const mp_obj_t *args) {
+    s3lcd_font_obj_t font_buf;
+    s3lcd_font_obj_t *font = s3lcd_font_get(args[1], &font_buf);
+    uint16_t print_width = 0;
+
+    GET_STR_DATA_LEN(args[2], str_data, str_len);
+    const byte *s = str_data, *top = str_data + str_len;
+
+    while (s < top) {
+        unichar ch;
+        ch = utf8_get_char(s);
+        s = utf8_next_char(s);
+
+        int char_index = s3lcd_font_glyph(font, ch);
+        if (char_index >= 0) {
+            print_width += s3lcd_font_width(font, char_index);
         }
     }
-
-    mp_raise_TypeError(MP_ERROR_TEXT("bitmap requires either module or tuple."));
-    return mp_const_none;
+    return mp_obj_new_int(print_width);
 }
-
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_bitmap_obj, 4, 6, s3lcd_bitmap);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_write_len_obj, 3, 3, s3lcd_write_len);
 
 ///
-/// .text(font, x, y, text {, color, background, alpha})
-/// Draw text on the screen using converted font module
+///	.write(font, s, x, y {, fg, bg, alpha, aa=False, outline=None, shadow=None, shadow_offset=2})
+/// write a string or character to the display.
 /// required parameters:
-/// -- font: a font module created by font2bitmap.py utility
-/// -- x: x position
-/// -- y: y position
-/// -- text: text to display
+/// -- font: a font module or Font object
+/// -- s: a string or a single character
+/// -- x: the x position of the string or character
+/// -- y: the y position of the string or character
 /// optional parameters:
-/// -- color: text color
-/// -- background: background color
-/// -- alpha: alpha value (0-255)
+/// -- fg: the foreground color of the string or character
+/// -- bg: the background color of the string or character
+/// -- alpha: the alpha value of the string or character
+/// -- aa: True to use the pixel values of a 2, 4 or 8 bpp font as coverage,
+///        blending fg over bg or over the frame buffer if bg is TRANSPARENT
+/// -- outline: color of a one pixel outline around the text
+/// -- shadow: color of a shadow down and to the right of the text
+/// -- shadow_offset: distance in pixels of the shadow, defaults to 2
 ///
 
-static mp_obj_t s3lcd_text(size_t n_args, const mp_obj_t *args) {
-    uint8_t single_char_s;
-    const uint8_t *source = NULL;
-    size_t source_len = 0;
+static mp_obj_t s3lcd_write(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_font, ARG_s, ARG_x, ARG_y, ARG_fg, ARG_bg, ARG_alpha, ARG_aa, ARG_outline, ARG_shadow, ARG_shadow_offset };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_s, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_x, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_y, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_fg, MP_ARG_INT, {.u_int = WHITE}},
+        {MP_QSTR_bg, MP_ARG_INT, {.u_int = BLACK}},
+        {MP_QSTR_alpha, MP_ARG_INT, {.u_int = 255}},
+        {MP_QSTR_aa, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}},
+        {MP_QSTR_outline, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_shadow, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_shadow_offset, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 2}},
+    };
 
-    // extract arguments
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[1]);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    frame_buffer_required(self);
+    s3lcd_font_obj_t font_buf;
+    s3lcd_font_obj_t *font = s3lcd_font_get(args[ARG_font].u_obj, &font_buf);
+
+    mp_int_t x = args[ARG_x].u_int;
+    mp_int_t y = args[ARG_y].u_int;
+    mp_int_t fg_color = args[ARG_fg].u_int;
+    mp_int_t bg_color = args[ARG_bg].u_int;
+    mp_int_t alpha = args[ARG_alpha].u_int;
+    mp_int_t outline = effect_color(args[ARG_outline].u_obj);
+    mp_int_t shadow = effect_color(args[ARG_shadow].u_obj);
+
+    GET_STR_DATA_LEN(args[ARG_s].u_obj, str_data, str_len);
+    const byte *s = str_data, *top = str_data + str_len;
 
-    if (mp_obj_is_int(args[2])) {
-        mp_int_t c = mp_obj_get_int(args[2]);
-        single_char_s = (c & 0xff);
-        source = &single_char_s;
-        source_len = 1;
-    } else if (mp_obj_is_str(args[2])) {
-        source = (uint8_t *) mp_obj_str_get_str(args[2]);
-        source_len = strlen((char *)source);
-    } else if (mp_obj_is_type(args[2], &mp_type_bytes)) {
-        mp_obj_t text_data_buff = args[2];
-        mp_buffer_info_t text_bufinfo;
-        mp_get_buffer_raise(text_data_buff, &text_bufinfo, MP_BUFFER_READ);
-        source = text_bufinfo.buf;
-        source_len = text_bufinfo.len;
-    } else {
-        mp_raise_TypeError(MP_ERROR_TEXT("text requires either int, str or bytes."));
-        return mp_const_none;
+    if (outline != -1 || shadow != -1) {
+        mp_int_t offset = effect_offset(args[ARG_shadow_offset].u_int);
+        return mp_obj_new_int(write_effects(self, font, s, top, x, y, fg_color, bg_color, alpha,
+            args[ARG_aa].u_bool, outline, shadow, offset));
     }
 
-    mp_int_t x0 = mp_obj_get_int(args[3]);
-    mp_int_t y0 = mp_obj_get_int(args[4]);
-
-    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
-    const uint8_t width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTH)));
-    const uint8_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
-    const uint8_t first = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FIRST)));
-    const uint8_t last = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_LAST)));
-
-    mp_obj_t font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));
-    mp_buffer_info_t bufinfo;
-    mp_get_buffer_raise(font_data_buff, &bufinfo, MP_BUFFER_READ);
-    const uint8_t *font_data = bufinfo.buf;
-
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, fg_color, WHITE)
-    OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, bg_color, BLACK)
-    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, alpha, 255)
+    text_style_t style;
+    text_style_init(&style, font->bpp, fg_color, bg_color, alpha, args[ARG_aa].u_bool);
 
-    uint8_t wide = width / 8;
+    uint16_t print_width = 0;
+    while (s < top) {
+        unichar ch;
+        ch = utf8_get_char(s);
+        s = utf8_next_char(s);
 
-    uint8_t chr;
-    while (source_len--) {
-        chr = *source++;
-        if (chr >= first && chr <= last) {
-            uint16_t buf_idx = 0;
-            uint16_t chr_idx = (chr - first) * (height * wide);
-            for (uint8_t line = 0; line < height; line++) {
-                uint16_t *b = self->frame_buffer + x0 + (y0 + line) * self->width;
-                for (uint8_t line_byte = 0; line_byte < wide; line_byte++) {
-                    uint8_t chr_data = font_data[chr_idx];
-                    for (uint8_t bit = 8; bit; bit--) {
-                        if (chr_data >> (bit - 1) & 1) {
-                            if (fg_color != -1) {
-                                if (alpha == 255) {
-                                    *b = fg_color;
-                                } else {
-                                    *b = alpha_blend_565(*b, fg_color, alpha);
-                                }
-                            }
-                        } else {
-                            if (bg_color != -1) {
-                                if (alpha == 255) {
-                                    *b = bg_color;
-                                } else {
-                                    *b = alpha_blend_565(*b, bg_color, alpha);
-                                }
-                            }
-                        }
-                        b++;
-                        buf_idx++;
-                    }
-                    chr_idx++;
-                }
-            }
-            x0 += width;
+        int char_index = s3lcd_font_glyph(font, ch);
+        if (char_index >= 0) {
+            uint8_t width = s3lcd_font_width(font, char_index);
+            draw_glyph(self, font, &style, ch, char_index, x, y);
+            x += width;
+            print_width += width;
         }
     }
-    return mp_const_none;
+    return mp_obj_new_int(print_width);
 }
+static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_write_obj, 5, s3lcd_write);
 
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_text_obj, 5, 8, s3lcd_text);
-
-static void set_rotation(s3lcd_obj_t *self) {
-
-    s3lcd_rotation_t *rotation = &self->rotations[self->rotation % self->rotations_len];
-    esp_lcd_panel_swap_xy(self->panel_handle, rotation->swap_xy);
-    esp_lcd_panel_mirror(self->panel_handle, rotation->mirror_x, rotation->mirror_y);
-    esp_lcd_panel_set_gap(self->panel_handle, rotation->x_gap, rotation->y_gap);
+//
+// text_break: return true if a line may break before character ch. Lines
+// break at spaces, after hyphens and around CJK characters, which are
+// written without spaces.
+//
 
-    self->width = rotation->width;
-    self->height = rotation->height;
+static bool text_break(unichar prev, unichar ch) {
+    return ch == ' ' || prev == '-' || prev >= 0x2e80 || ch >= 0x2e80;
 }
 
 ///
-/// .rotation(rotation)
-/// Set the display rotation.
+/// .write_box(font, s, x, y, w, h {, align, line_spacing, fg, bg, alpha, aa=False})
+/// write a string to the display, word wrapped to fit in a box.
 /// required parameters:
-/// -- rotation: 0=Portrait, 1=Landscape, 2=Reverse Portrait (180), 3=Reverse Landscape (180)
+/// -- font: a font module or Font object
+/// -- s: a string
+/// -- x: the x position of the box
+/// -- y: the y position of the box
+/// -- w: the width of the box
+/// -- h: the height of the box
+/// optional parameters:
+/// -- align: LEFT, CENTER or RIGHT, defaults to LEFT
+/// -- line_spacing: pixels between lines, defaults to 0
+/// -- fg: the foreground color of the string
+/// -- bg: the background color of the string
+/// -- alpha: the alpha value of the string
+/// -- aa: True to draw 2, 4 or 8 bpp fonts anti-aliased, see write()
+/// returns:
+/// -- tuple of the number of characters consumed and the x, y position where
+///    the next character would be written
 ///
 
-static mp_obj_t s3lcd_rotation(mp_obj_t self_in, mp_obj_t value) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_int_t rotation = mp_obj_get_int(value) % 4;
+static mp_obj_t s3lcd_write_box(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_font, ARG_s, ARG_x, ARG_y, ARG_w, ARG_h, ARG_align, ARG_line_spacing, ARG_fg, ARG_bg, ARG_alpha, ARG_aa };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_s, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_x, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_y, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_w, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_h, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_align, MP_ARG_INT, {.u_int = ALIGN_LEFT}},
+        {MP_QSTR_line_spacing, MP_ARG_INT, {.u_int = 0}},
+        {MP_QSTR_fg, MP_ARG_INT, {.u_int = WHITE}},
+        {MP_QSTR_bg, MP_ARG_INT, {.u_int = BLACK}},
+        {MP_QSTR_alpha, MP_ARG_INT, {.u_int = 255}},
+        {MP_QSTR_aa, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}},
+    };
 
-    self->rotation = rotation;
-    set_rotation(self);
-    return mp_const_none;
-}
-static MP_DEFINE_CONST_FUN_OBJ_2(s3lcd_rotation_obj, s3lcd_rotation);
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
-///
-/// .width()
-/// Returns the width of the display in pixels.
-///
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    frame_buffer_required(self);
+    s3lcd_font_obj_t font_buf;
+    s3lcd_font_obj_t *font = s3lcd_font_get(args[ARG_font].u_obj, &font_buf);
 
-static mp_obj_t s3lcd_width(mp_obj_t self_in) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    return mp_obj_new_int(self->width);
-}
-static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_width_obj, s3lcd_width);
+    mp_int_t box_x = args[ARG_x].u_int;
+    mp_int_t box_y = args[ARG_y].u_int;
+    mp_int_t box_w = args[ARG_w].u_int;
+    mp_int_t box_bottom = box_y + args[ARG_h].u_int;
+    mp_int_t align = args[ARG_align].u_int;
 
-///
-/// .height()
-/// Returns the height of the display in pixels.
-///
+    text_style_t style;
+    text_style_init(&style, font->bpp, args[ARG_fg].u_int, args[ARG_bg].u_int, args[ARG_alpha].u_int, args[ARG_aa].u_bool);
 
-static mp_obj_t s3lcd_height(mp_obj_t self_in) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    return mp_obj_new_int(self->height);
-}
-static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_height_obj, s3lcd_height);
+    GET_STR_DATA_LEN(args[ARG_s].u_obj, str_data, str_len);
+    const byte *s = str_data, *top = str_data + str_len;
+    mp_int_t x = box_x;
+    mp_int_t y = box_y;
+
+    while (s < top && y + font->height <= box_bottom) {
+        // measure the line, remembering the last place it may break
+        const byte *p = s, *end = top, *next = top;
+        const byte *brk_end = NULL, *brk_next = NULL;
+        mp_int_t line_width = 0, brk_width = 0;
+        unichar prev = 0;
+
+        while (p < top) {
+            unichar ch = utf8_get_char(p);
+            const byte *after = utf8_next_char(p);
+
+            if (ch == '\n') {
+                end = p;
+                next = after;
+                break;
+            }
 
-///
-/// .vscrdef(tfa, vsa, bfa)
-/// Set the vertical scrolling definition.
-/// required parameters:
-/// -- tfa: Top Fixed Area line
-/// -- vsa: Vertical Scrolling Area line
-/// -- bfa: Bottom Fixed Area line
-///
+            if (p != s && text_break(prev, ch)) {
+                brk_end = p;
+                brk_next = (ch == ' ') ? after : p;
+                brk_width = line_width;
+            }
 
-static mp_obj_t s3lcd_vscrdef(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t tfa = mp_obj_get_int(args[1]);
-    mp_int_t vsa = mp_obj_get_int(args[2]);
-    mp_int_t bfa = mp_obj_get_int(args[3]);
+            int char_index = s3lcd_font_glyph(font, ch);
+            mp_int_t char_width = (char_index >= 0) ? s3lcd_font_width(font, char_index) : 0;
+            if (line_width + char_width > box_w && p != s) {
+                if (brk_end) {
+                    end = brk_end;
+                    next = brk_next;
+                    line_width = brk_width;
+                } else {
+                    end = p;
+                    next = p;
+                }
+                break;
+            }
 
-    uint8_t buf[6] = {(tfa) >> 8, (tfa) & 0xFF, (vsa) >> 8, (vsa) & 0xFF, (bfa) >> 8, (bfa) & 0xFF};
-    esp_lcd_panel_io_tx_param(self->io_handle, LCD_CMD_VSCRDEF, buf, 6);
-    return mp_const_none;
+            line_width += char_width;
+            prev = ch;
+            p = after;
+        }
+
+        if (p == top) {
+            end = top;
+            next = top;
+        }
+
+        // drop trailing spaces from the width of the line
+        const byte *last = end;
+        while (last > s && last[-1] == ' ') {
+            last--;
+            int char_index = s3lcd_font_glyph(font, ' ');
+            if (char_index >= 0) {
+                line_width -= s3lcd_font_width(font, char_index);
+            }
+        }
+
+        x = box_x;
+        if (align == ALIGN_CENTER) {
+            x += (box_w - line_width) / 2;
+        } else if (align == ALIGN_RIGHT) {
+            x += box_w - line_width;
+        }
+
+        while (s < last) {
+            unichar ch = utf8_get_char(s);
+            s = utf8_next_char(s);
+            int char_index = s3lcd_font_glyph(font, ch);
+            if (char_index >= 0) {
+                draw_glyph(self, font, &style, ch, char_index, x, y);
+                x += s3lcd_font_width(font, char_index);
+            }
+        }
+
+        // continue on the next line after a newline or wrap, wrapped lines
+        // do not start with the spaces they were broken at
+        s = next;
+        if (end != top) {
+            x = box_x;
+            y += font->height + args[ARG_line_spacing].u_int;
+            if (*end != '\n') {
+                while (s < top && *s == ' ') {
+                    s++;
+                }
+            }
+        }
+    }
+
+    mp_obj_t result[3] = {
+        mp_obj_new_int(utf8_charlen(str_data, s - str_data)),
+        mp_obj_new_int(x),
+        mp_obj_new_int(y),
+    };
+    return mp_obj_new_tuple(3, result);
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_vscrdef_obj, 4, 4, s3lcd_vscrdef);
+static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_write_box_obj, 7, s3lcd_write_box);
 
-///
-/// .vscsad(vssa)
-/// Set the vertical scrolling start address.
-/// required parameters:
-/// -- vssa: Vertical Scrolling Start Address
-///
+//
+// Signed distance field fonts
+//
+// Distance field fonts created by the font2sdf utility store 8 bit distances
+// to the edge of each character instead of pixels. 128 is on the edge, and
+// each SPREAD pixels inside or outside the edge adds or subtracts 127. Each
+// glyph has SPREAD pixels of padding on every side, so glyph cells overlap
+// when written. Text can be drawn at any height by sampling the fields with
+// bilinear interpolation and mapping distance to coverage.
+//
 
-static mp_obj_t s3lcd_vscsad(mp_obj_t self_in, mp_obj_t vssa_in) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_int_t vssa = mp_obj_get_int(vssa_in);
+//
+// sdf_sample: return the distance at u, v in 16.16 fixed-point field pixels,
+// interpolated between the four nearest distances, as 8.8 fixed-point.
+//
 
-    uint8_t buf[2] = {(vssa) >> 8, (vssa) & 0xFF};
-    esp_lcd_panel_io_tx_param(self->io_handle, ST77XX_VSCSAD, buf, 2);
-    return mp_const_none;
+static inline int32_t sdf_sample(const uint8_t *field, int width, int height, int32_t u, int32_t v) {
+    int ui = u >> 16;
+    int vi = v >> 16;
+    int32_t fu = (u >> 8) & 0xff;
+    int32_t fv = (v >> 8) & 0xff;
+    int u1 = (ui + 1 < width) ? ui + 1 : ui;
+    int v1 = (vi + 1 < height) ? vi + 1 : vi;
+
+    const uint8_t *r0 = field + vi * width;
+    const uint8_t *r1 = field + v1 * width;
+    int32_t top = (r0[ui] << 8) + (r0[u1] - r0[ui]) * fu;
+    int32_t bottom = (r1[ui] << 8) + (r1[u1] - r1[ui]) * fu;
+    return top + (((bottom - top) * fv) >> 8);
 }
-static MP_DEFINE_CONST_FUN_OBJ_2(s3lcd_vscsad_obj, s3lcd_vscsad);
 
-static bool lcd_panel_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
-    lcd_panel_active = false;
-    return false;
+//
+// draw_sdf_glyph: blend the distance field glyph char_index into the frame
+// buffer. Frame buffer column px maps to field column
+// ((px - x0) * step + step / 2 - 0.5) in 16.16 fixed-point, and rows likewise.
+// sharpness converts 8.8 distances from the edge to coverage.
+//
+
+static void draw_sdf_glyph(s3lcd_obj_t *self, s3lcd_font_obj_t *font, int char_index,
+    int x0, int y0, int32_t step, int32_t sharpness, uint16_t color, uint8_t alpha) {
+
+    const int width = s3lcd_font_width(font, char_index);
+    const int height = font->height;
+    const int32_t u_max = (width - 1) << 16;
+    const int32_t v_max = (height - 1) << 16;
+    const int32_t start = step / 2 - 32768;
+
+    bitstream_t bs;
+    s3lcd_font_bitmap(font, char_index, &bs);
+    const uint8_t *field = bs.data + bs.bit / 8;
+
+    // frame buffer area covered by the glyph cell
+    int left = x0;
+    int top = y0;
+    int right = x0 + (int)(((int64_t)width << 16) / step) + 1;
+    int bottom = y0 + (int)(((int64_t)height << 16) / step) + 1;
+    if (left < 0) {
+        left = 0;
+    }
+    if (top < 0) {
+        top = 0;
+    }
+    if (right > self->width) {
+        right = self->width;
+    }
+    if (bottom > self->height) {
+        bottom = self->height;
+    }
+
+    for (int py = top; py < bottom; py++) {
+        int32_t v = (py - y0) * step + start;
+        if (v < 0 || v > v_max) {
+            continue;
+        }
+        uint16_t *b = &self->frame_buffer[py * self->width + left];
+        int32_t u = (left - x0) * step + start;
+        for (int px = left; px < right; px++, b++, u += step) {
+            if (u < 0 || u > u_max) {
+                continue;
+            }
+            int32_t coverage = 128 + (((sdf_sample(field, width, height, u, v) - 32768) * sharpness) >> 16);
+            if (coverage <= 0) {
+                continue;
+            }
+            if (coverage > 255) {
+                coverage = 255;
+            }
+            uint8_t a = (coverage * alpha) / 255;
+            *b = (a == 255) ? color : alpha_blend_565(color, *b, a);
+        }
+    }
 }
 
 ///
-/// .scroll(xstep, ystep{, fill=0})
-/// Scroll the framebuffer in the given direction.
+/// .write_sdf(font, s, x, y, height {, fg, bg, alpha})
+/// write a string or character to the display using a distance field font
+/// scaled to any height, with anti-aliased edges.
 /// required parameters:
-/// -- xstep: Number of pixels to scroll in the x direction. Negative values scroll left, positive values scroll right.
-/// -- ystep: Number of pixels to scroll in the y direction. Negative values scroll up, positive values scroll down.
+/// -- font: a distance field font module created by font2sdf
+/// -- s: a string or a single character
+/// -- x: the x position of the string or character
+/// -- y: the y position of the string or character
+/// -- height: the height of the text in pixels
 /// optional parameters:
-/// -- fill: Fill color for the new pixels.
+/// -- fg: the foreground color of the string or character
+/// -- bg: the background color of the string or character or TRANSPARENT
+/// -- alpha: the alpha value of the string or character
+/// returns:
+/// -- the width of the string in pixels
 ///
-/// Based on the MicroPython framedbuffer scroll function.
 
-static mp_obj_t s3lcd_scroll(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t xstep = mp_obj_get_int(args[1]);
-    mp_int_t ystep = mp_obj_get_int(args[2]);
-    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, fill, 0)
+static mp_obj_t s3lcd_write_sdf(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_font, ARG_s, ARG_x, ARG_y, ARG_height, ARG_fg, ARG_bg, ARG_alpha };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_s, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_x, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_y, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_height, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_fg, MP_ARG_INT, {.u_int = WHITE}},
+        {MP_QSTR_bg, MP_ARG_INT, {.u_int = BLACK}},
+        {MP_QSTR_alpha, MP_ARG_INT, {.u_int = 255}},
+    };
 
-    int sx, y, xend, yend, dx, dy;
-    if (xstep < 0) {
-        sx = 0;
-        xend = self->width + xstep;
-        if (xend <= 0) {
-            return mp_const_none;
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    frame_buffer_required(self);
+    s3lcd_font_obj_t font_buf;
+    s3lcd_font_obj_t *font = s3lcd_font_get(args[ARG_font].u_obj, &font_buf);
+    if (font->spread == 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("font is not a distance field font"));
+    }
+
+    mp_int_t x = args[ARG_x].u_int;
+    mp_int_t y = args[ARG_y].u_int;
+    mp_int_t height = args[ARG_height].u_int;
+    mp_int_t fg_color = args[ARG_fg].u_int;
+    mp_int_t bg_color = args[ARG_bg].u_int;
+    mp_int_t alpha = args[ARG_alpha].u_int;
+    if (height < 1 || height > 1024) {
+        mp_raise_ValueError(MP_ERROR_TEXT("height must be 1 to 1024"));
+    }
+
+    const int spread = font->spread;
+    const int text_height = font->height - spread * 2;
+
+    // field pixels per frame buffer pixel in 16.16 fixed-point, and the 8.8
+    // coverage per 8.8 distance, limited so the coverage math fits 32 bits
+    int32_t step = ((int32_t)text_height << 16) / height;
+    int64_t sharpness = ((int64_t)255 * spread * height * 256) / (127 * text_height);
+    if (sharpness > 65535) {
+        sharpness = 65535;
+    }
+
+    GET_STR_DATA_LEN(args[ARG_s].u_obj, str_data, str_len);
+    const byte *s = str_data, *top = str_data + str_len;
+
+    // advance of the string in field pixels
+    mp_int_t advance = 0;
+    while (s < top) {
+        int char_index = s3lcd_font_glyph(font, utf8_get_char(s));
+        s = utf8_next_char(s);
+        if (char_index >= 0) {
+            advance += s3lcd_font_width(font, char_index) - spread * 2;
         }
-        dx = 1;
-    } else {
-        sx = self->width - 1;
-        xend = xstep - 1;
-        if (xend >= sx) {
-            return mp_const_none;
+    }
+    mp_int_t print_width = (advance * height + text_height / 2) / text_height;
+
+    if (bg_color != -1) {
+        mp_int_t left = (x < 0) ? 0 : x;
+        mp_int_t top_y = (y < 0) ? 0 : y;
+        mp_int_t right = (x + print_width > self->width) ? self->width : x + print_width;
+        mp_int_t bottom = (y + height > self->height) ? self->height : y + height;
+        if (left < right && top_y < bottom) {
+            _fill_rect(self, left, top_y, right - left, bottom - top_y, bg_color, alpha);
         }
-        dx = -1;
     }
-    if (ystep < 0) {
-        y = 0;
-        yend = self->height + ystep;
-        if (yend <= 0) {
-            return mp_const_none;
+
+    // the padding of each glyph cell starts spread field pixels before the pen
+    mp_int_t pen = 0;
+    mp_int_t pad = (spread * height + text_height / 2) / text_height;
+    s = str_data;
+    while (s < top) {
+        int char_index = s3lcd_font_glyph(font, utf8_get_char(s));
+        s = utf8_next_char(s);
+        if (char_index >= 0) {
+            int cell_x = x + (pen * height + text_height / 2) / text_height - pad;
+            draw_sdf_glyph(self, font, char_index, cell_x, y - pad, step, (int32_t)sharpness, fg_color, alpha);
+            pen += s3lcd_font_width(font, char_index) - spread * 2;
         }
-        dy = 1;
-    } else {
-        y = self->height - 1;
-        yend = ystep - 1;
-        if (yend >= y) {
-            return mp_const_none;
+    }
+    return mp_obj_new_int(print_width);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_write_sdf_obj, 6, s3lcd_write_sdf);
+
+//
+// Label
+//
+// A Label renders its text into its own buffer when the text or style
+// changes, so drawing it is a row copy. Labels with an opaque background
+// hold RGB565 pixels, labels with a transparent background hold the 0-255
+// foreground coverage of each pixel and are blended when drawn.
+//
+
+static void label_render(s3lcd_label_obj_t *label) {
+    s3lcd_font_obj_t *font = label->font;
+
+    GET_STR_DATA_LEN(label->text, str_data, str_len);
+    const byte *s, *top = str_data + str_len;
+
+    size_t width = 0;
+    for (s = str_data; s < top; s = utf8_next_char(s)) {
+        int char_index = s3lcd_font_glyph(font, utf8_get_char(s));
+        if (char_index >= 0) {
+            width += s3lcd_font_width(font, char_index);
         }
-        dy = -1;
+    }
+    if (width > UINT16_MAX) {
+        mp_raise_ValueError(MP_ERROR_TEXT("label text is too wide"));
     }
 
-    for (; y != yend; y += dy) {
-        for (int x = sx; x != xend; x += dx) {
-            int src_x = x - xstep;
-            int src_y = y - ystep;
-            if (src_x >= 0 && src_x < self->width && src_y >= 0 && src_y < self->height) {
-                self->frame_buffer[y * self->width + x] = self->frame_buffer[src_y * self->width + src_x];
-            } else {
-                self->frame_buffer[y * self->width + x] = fill;
+    bool transparent = (label->bg_color == -1);
+    size_t size = width * font->height * (transparent ? sizeof(uint8_t) : sizeof(uint16_t));
+    if (size > label->buffer_size) {
+        m_free(label->buffer);
+        label->buffer = m_malloc(size);
+        label->buffer_size = size;
+    }
+    label->width = width;
+    label->height = font->height;
+
+    if (transparent) {
+        const int levels = (1 << font->bpp) - 1;
+        uint8_t coverage[256];
+        for (int i = 0; i <= levels; i++) {
+            coverage[i] = label->aa ? i * 255 / levels : (i ? 255 : 0);
+        }
+
+        // glyph bitmaps clipped to the label, overlapping glyphs keep the
+        // larger coverage
+        uint8_t *mask = label->buffer;
+        memset(mask, 0, size);
+        int x = 0;
+        for (s = str_data; s < top; s = utf8_next_char(s)) {
+            int char_index = s3lcd_font_glyph(font, utf8_get_char(s));
+            if (char_index >= 0) {
+                int bearing;
+                uint8_t char_width = s3lcd_font_box(font, char_index, &bearing);
+                bitstream_t bs;
+                s3lcd_font_bitmap(font, char_index, &bs);
+                uint8_t indexes[256];
+                uint8_t *dst = mask;
+                for (int row = 0; row < font->height; row++) {
+                    unpack_indexes(&bs, font->bpp, indexes, char_width);
+                    for (int i = 0; i < char_width; i++) {
+                        int col = x + bearing + i;
+                        if (col >= 0 && col < (int)width && coverage[indexes[i]] > dst[col]) {
+                            dst[col] = coverage[indexes[i]];
+                        }
+                    }
+                    dst += width;
+                }
+                x += s3lcd_font_width(font, char_index);
             }
         }
+        return;
+    }
+
+    // draw the glyphs with a display object whose frame buffer is the label
+    s3lcd_obj_t canvas;
+    memset(&canvas, 0, sizeof(canvas));
+    canvas.frame_buffer = label->buffer;
+    canvas.width = width;
+    canvas.height = font->height;
+
+    text_style_t style;
+    text_style_init(&style, font->bpp, label->fg_color, label->bg_color, 255, label->aa);
+
+    int x = 0;
+    for (s = str_data; s < top; s = utf8_next_char(s)) {
+        unichar ch = utf8_get_char(s);
+        int char_index = s3lcd_font_glyph(font, ch);
+        if (char_index >= 0) {
+            draw_glyph(&canvas, font, &style, ch, char_index, x, 0);
+            x += s3lcd_font_width(font, char_index);
+        }
     }
+}
 
-    return mp_const_none;
+static void s3lcd_label_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    s3lcd_label_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<Label width=%u, height=%u>", self->width, self->height);
 }
 
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_scroll_obj, 3, 4, s3lcd_scroll);
+///
+/// s3lcd.Label(font, text {, fg, bg, alpha, aa=False})
+/// Render text once for drawing with the blit_label() method.
+/// required parameters:
+/// -- font: a font module or Font object
+/// -- text: the text of the label
+/// optional parameters:
+/// -- fg: the foreground color, defaults to WHITE
+/// -- bg: the background color or TRANSPARENT, defaults to BLACK
+/// -- alpha: the alpha value used when drawing, defaults to 255
+/// -- aa: True to render 2, 4 or 8 bpp fonts anti-aliased, see write()
+///
+
+static mp_obj_t s3lcd_label_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_font, ARG_text, ARG_fg, ARG_bg, ARG_alpha, ARG_aa };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_text, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_fg, MP_ARG_INT, {.u_int = WHITE}},
+        {MP_QSTR_bg, MP_ARG_INT, {.u_int = BLACK}},
+        {MP_QSTR_alpha, MP_ARG_INT, {.u_int = 255}},
+        {MP_QSTR_aa, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = false}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    s3lcd_label_obj_t *self = m_new_obj(s3lcd_label_obj_t);
+    self->base.type = &s3lcd_label_type;
+    self->font_obj = args[ARG_font].u_obj;
+    self->font = s3lcd_font_get(self->font_obj, &self->font_buf);
+    self->text = args[ARG_text].u_obj;
+    self->fg_color = args[ARG_fg].u_int;
+    self->bg_color = args[ARG_bg].u_int;
+    self->alpha = args[ARG_alpha].u_int;
+    self->aa = args[ARG_aa].u_bool;
+    self->buffer = NULL;
+    self->buffer_size = 0;
+    label_render(self);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+///
+/// .set({text, fg, bg, alpha, aa})
+/// Change the text or style of the label, the text is only rendered again
+/// if the text, colors or aa changed.
+/// optional parameters:
+/// -- text: the text of the label
+/// -- fg: the foreground color
+/// -- bg: the background color or TRANSPARENT
+/// -- alpha: the alpha value used when drawing
+/// -- aa: True to render anti-aliased
+/// returns:
+/// -- True if the label was rendered again
+///
+
+static mp_obj_t s3lcd_label_set(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_text, ARG_fg, ARG_bg, ARG_alpha, ARG_aa };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_text, MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_fg, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_bg, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_alpha, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_aa, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    s3lcd_label_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    bool changed = false;
+
+    if (args[ARG_text].u_obj != MP_OBJ_NULL && !mp_obj_equal(args[ARG_text].u_obj, self->text)) {
+        self->text = args[ARG_text].u_obj;
+        changed = true;
+    }
+    if (args[ARG_fg].u_obj != MP_OBJ_NULL && mp_obj_get_int(args[ARG_fg].u_obj) != self->fg_color) {
+        self->fg_color = mp_obj_get_int(args[ARG_fg].u_obj);
+        changed = true;
+    }
+    if (args[ARG_bg].u_obj != MP_OBJ_NULL && mp_obj_get_int(args[ARG_bg].u_obj) != self->bg_color) {
+        self->bg_color = mp_obj_get_int(args[ARG_bg].u_obj);
+        changed = true;
+    }
+    if (args[ARG_aa].u_obj != MP_OBJ_NULL && mp_obj_is_true(args[ARG_aa].u_obj) != self->aa) {
+        self->aa = mp_obj_is_true(args[ARG_aa].u_obj);
+        changed = true;
+    }
+    if (args[ARG_alpha].u_obj != MP_OBJ_NULL) {
+        self->alpha = mp_obj_get_int(args[ARG_alpha].u_obj);
+    }
+
+    if (changed) {
+        label_render(self);
+    }
+    return mp_obj_new_bool(changed);
+}
+static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_label_set_obj, 1, s3lcd_label_set);
+
+///
+/// .size()
+/// returns:
+/// -- tuple of the width and height of the label in pixels
+///
+
+static mp_obj_t s3lcd_label_size(mp_obj_t self_in) {
+    s3lcd_label_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_obj_t result[2] = {
+        mp_obj_new_int(self->width),
+        mp_obj_new_int(self->height),
+    };
+    return mp_obj_new_tuple(2, result);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_label_size_obj, s3lcd_label_size);
+
+static const mp_rom_map_elem_t s3lcd_label_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_set), MP_ROM_PTR(&s3lcd_label_set_obj)},
+    {MP_ROM_QSTR(MP_QSTR_size), MP_ROM_PTR(&s3lcd_label_size_obj)},
+};
+static MP_DEFINE_CONST_DICT(s3lcd_label_locals_dict, s3lcd_label_locals_dict_table);
+
+#if MICROPY_OBJ_TYPE_REPR == MICROPY_OBJ_TYPE_REPR_SLOT_INDEX
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    s3lcd_label_type,
+    MP_QSTR_Label,
+    MP_TYPE_FLAG_NONE,
+    print, s3lcd_label_print,
+    make_new, s3lcd_label_make_new,
+    locals_dict, &s3lcd_label_locals_dict);
+
+#else
+
+const mp_obj_type_t s3lcd_label_type = {
+    {&mp_type_type},
+    .name = MP_QSTR_Label,
+    .print = s3lcd_label_print,
+    .make_new = s3lcd_label_make_new,
+    .locals_dict = (mp_obj_dict_t *)&s3lcd_label_locals_dict,
+};
+
+#endif
 
 //
-// run custom_init
+// label_blit: copy an opaque label or blend a transparent one to x, y,
+// clipped to the frame buffer.
 //
 
-static void custom_init(s3lcd_obj_t *self) {
-    size_t init_len;
-    mp_obj_t *init_list;
+static void label_blit(s3lcd_obj_t *self, s3lcd_label_obj_t *label, mp_int_t x, mp_int_t y) {
+    if (label->width == 0 || label->alpha == 0) {
+        return;
+    }
 
-    mp_obj_get_array(self->custom_init, &init_len, &init_list);
-    for (int idx = 0; idx < init_len; idx++) {
-        size_t init_cmd_len;
-        mp_obj_t *init_cmd;
-        mp_obj_get_array(init_list[idx], &init_cmd_len, &init_cmd);
-        mp_buffer_info_t init_cmd_data_info;
-        if (mp_get_buffer(init_cmd[0], &init_cmd_data_info, MP_BUFFER_READ)) {
-            uint8_t *init_cmd_data = (uint8_t *)init_cmd_data_info.buf;
-            if (init_cmd_data_info.len > 1) {
-                esp_lcd_panel_io_tx_param(self->io_handle, init_cmd_data[0], &init_cmd_data[1], init_cmd_data_info.len - 1);
-            } else {
-                esp_lcd_panel_io_tx_param(self->io_handle, init_cmd_data[0], NULL, 0);
-            }
-            mp_hal_delay_ms(10);
-            // check for delay
-            if (init_cmd_len > 1) {
-                mp_int_t delay = mp_obj_get_int(init_cmd[1]);
-                if (delay > 0) {
-                    mp_hal_delay_ms(delay);
-                }
+    if (label->bg_color == -1) {
+        blend_coverage(self, x, y, label->buffer, label->width, label->height, label->fg_color, label->alpha);
+        return;
+    }
+
+    int left = (x < 0) ? -x : 0;
+    int top = (y < 0) ? -y : 0;
+    int right = (x + label->width > self->width) ? self->width - x : label->width;
+    int bottom = (y + label->height > self->height) ? self->height - y : label->height;
+    if (left >= right) {
+        return;
+    }
+
+    for (int row = top; row < bottom; row++) {
+        const uint16_t *src = (const uint16_t *)label->buffer + row * label->width + left;
+        uint16_t *dst = &self->frame_buffer[(y + row) * self->width + x + left];
+        if (label->alpha == 255) {
+            memcpy(dst, src, (right - left) * sizeof(uint16_t));
+        } else {
+            for (int col = left; col < right; col++) {
+                *dst = alpha_blend_565(*src++, *dst, label->alpha);
+                dst++;
             }
         }
     }
 }
 
-
 ///
-/// .init()
-/// Initialize the display, This method must be called before any other methods.
+/// .blit_label(label, x, y)
+/// Draw a Label object.
+/// required parameters:
+/// -- label: a Label object
+/// -- x: the x position of the label
+/// -- y: the y position of the label
 ///
 
-static mp_obj_t s3lcd_init(mp_obj_t self_in) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+static mp_obj_t s3lcd_blit_label(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    if (!mp_obj_is_type(args[1], &s3lcd_label_type)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("blit_label requires a Label"));
+    }
+    s3lcd_label_obj_t *label = MP_OBJ_TO_PTR(args[1]);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
 
-    if (mp_obj_is_type(self->bus, &s3lcd_i80_bus_type)) {
-        ESP_LOGI(TAG, "Initialize Intel 8080 bus");
-        s3lcd_i80_bus_obj_t *config = MP_OBJ_TO_PTR(self->bus);
-        self->swap_color_bytes = false;
-        self->bus_handle.i80 = NULL;
-        esp_lcd_i80_bus_config_t bus_config = {
-            .dc_gpio_num = config->dc_gpio_num,
-            .wr_gpio_num = config->wr_gpio_num,
-            .clk_src = LCD_CLK_SRC_PLL160M, // same as default in IDF5 and 0 in the enum of IDF4.4
-            .data_gpio_nums = {
-                config->data_gpio_nums[0],
-                config->data_gpio_nums[1],
-                config->data_gpio_nums[2],
-                config->data_gpio_nums[3],
-                config->data_gpio_nums[4],
-                config->data_gpio_nums[5],
-                config->data_gpio_nums[6],
-                config->data_gpio_nums[7],
-            },
-            .bus_width = config->bus_width,
-            .max_transfer_bytes = self->dma_buffer_size,
-        };
+    label_blit(self, label, x, y);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_blit_label_obj, 4, 4, s3lcd_blit_label);
 
-        ESP_ERROR_CHECK(esp_lcd_new_i80_bus(&bus_config, &self->bus_handle.i80));
-        esp_lcd_panel_io_handle_t io_handle = NULL;
-        esp_lcd_panel_io_i80_config_t io_config = {
-            .cs_gpio_num = config->cs_gpio_num,
-            .pclk_hz = config->pclk_hz,
-            .trans_queue_depth = 10,
-            .on_color_trans_done = lcd_panel_done,
-            .user_ctx = self,
-            .dc_levels = {
-                .dc_idle_level = config->dc_levels.dc_idle_level,
-                .dc_cmd_level = config->dc_levels.dc_cmd_level,
-                .dc_dummy_level = config->dc_levels.dc_dummy_level,
-                .dc_data_level = config->dc_levels.dc_data_level,
-            },
-            .lcd_cmd_bits = config->lcd_cmd_bits,
-            .lcd_param_bits = config->lcd_param_bits,
-            .flags = {
-                .cs_active_high = config->flags.cs_active_high,
-                .reverse_color_bits = config->flags.reverse_color_bits,
-                .swap_color_bytes = config->flags.swap_color_bytes,
-                .pclk_active_neg = config->flags.pclk_active_neg,
-                .pclk_idle_low = config->flags.pclk_idle_low,
-            }
-        };
+///
+/// .glyph_cache({size})
+/// Set the size of the decoded glyph cache used by write(). Glyphs are stored
+/// with one byte per pixel and the least recently used glyphs are discarded
+/// when the cache is full.
+/// optional parameters:
+/// -- size: cache size in bytes, 0 frees the cache
+/// returns:
+/// -- tuple of (size, used, hits, misses)
+///
 
-        ESP_ERROR_CHECK(esp_lcd_new_panel_io_i80(self->bus_handle.i80, &io_config, &io_handle));
-        self->io_handle = io_handle;
-    } else if (mp_obj_is_type(self->bus, &s3lcd_spi_bus_type)) {
-         s3lcd_spi_bus_obj_t *config = MP_OBJ_TO_PTR(self->bus);
-        self->swap_color_bytes = config->flags.swap_color_bytes;
-        spi_bus_config_t buscfg = {
-            .sclk_io_num = config->sclk_io_num,
-            .mosi_io_num = config->mosi_io_num,
-            .miso_io_num = -1,
-            .quadwp_io_num = -1,
-            .quadhd_io_num = -1,
-            .max_transfer_sz = self->dma_buffer_size
-        };
-        ESP_ERROR_CHECK(spi_bus_initialize(config->spi_host, &buscfg, SPI_DMA_CH_AUTO));
-        esp_lcd_panel_io_handle_t io_handle = NULL;
-        esp_lcd_panel_io_spi_config_t io_config = {
-            .dc_gpio_num = config->dc_gpio_num,
-            .cs_gpio_num = config->cs_gpio_num,
-            .pclk_hz = config->pclk_hz,
-            .spi_mode = 0,
-            .trans_queue_depth = 10,
-            .lcd_cmd_bits = config->lcd_cmd_bits,
-            .lcd_param_bits = config->lcd_param_bits,
-            .on_color_trans_done = lcd_panel_done,
-            .user_ctx = self,
-#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
-            .flags.dc_as_cmd_phase = config->flags.dc_as_cmd_phase,
-#endif
-            .flags.dc_low_on_data = config->flags.dc_low_on_data,
-            .flags.octal_mode =config->flags.octal_mode,
-            .flags.lsb_first = config->flags.lsb_first
-        };
+static mp_obj_t s3lcd_glyph_cache(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
 
-        ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)config->spi_host, &io_config, &io_handle));
-        self->io_handle = io_handle;
+    if (n_args > 1) {
+        mp_int_t size = mp_obj_get_int(args[1]);
+        if (size < 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("size must be >= 0"));
+        }
+        s3lcd_glyph_cache_free(self->glyph_cache);
+        self->glyph_cache = (size) ? s3lcd_glyph_cache_new(size) : NULL;
     }
 
-    esp_lcd_panel_handle_t panel_handle = NULL;
-    esp_lcd_panel_dev_config_t panel_config = {
-        .reset_gpio_num = self->rst,
-        .color_space = self->color_space,
-        .bits_per_pixel = 16,
+    s3lcd_glyph_cache_t *cache = self->glyph_cache;
+    mp_obj_t result[4] = {
+        mp_obj_new_int(cache ? cache->size : 0),
+        mp_obj_new_int(cache ? cache->used : 0),
+        mp_obj_new_int(cache ? cache->hits : 0),
+        mp_obj_new_int(cache ? cache->misses : 0)
     };
+    return mp_obj_new_tuple(4, result);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_glyph_cache_obj, 1, 2, s3lcd_glyph_cache);
 
-    ESP_ERROR_CHECK(esp_lcd_new_panel_st7789(self->io_handle, &panel_config, &panel_handle));
-    self->panel_handle = panel_handle;
+///
+/// .bitmap(bitmap, x, y {, alpha})
+/// required parameters:
+/// -- bitmap: a tuple of (width, height, data)
+/// -- x: x position
+/// -- y: y position
+/// optional parameters:
+/// -- alpha: alpha value (0-255)
+///
 
-    esp_lcd_panel_reset(panel_handle);
-    if (self->custom_init == MP_OBJ_NULL) {
-        esp_lcd_panel_init(panel_handle);
-#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
-        esp_lcd_panel_disp_on_off(panel_handle,true); //switch lcd on, not longer a part of init
-#endif
-    } else {
-        custom_init(self);
+static mp_obj_t s3lcd_bitmap_from_tuple(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_obj_t *bitmap_tuple = NULL;
+    size_t bitmap_tuple_len = 0;
+    mp_obj_tuple_get(args[1], &bitmap_tuple_len, &bitmap_tuple);
+    if (bitmap_tuple_len != 3) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bitmap tuple must have 3 elements"));
     }
-    esp_lcd_panel_invert_color(panel_handle, self->inversion_mode);
-    set_rotation(self);
 
-    self->frame_buffer = m_malloc(self->frame_buffer_size);
-    memset(self->frame_buffer, 0, self->frame_buffer_size);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
 
-    // esp_lcd_panel_io_tx_param(self->io_handle, 0x13, NULL, 0);
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(bitmap_tuple[0], &bufinfo, MP_BUFFER_READ);
+
+    mp_int_t width = mp_obj_get_int(bitmap_tuple[1]);
+    mp_int_t height = mp_obj_get_int(bitmap_tuple[2]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, alpha, 255)
 
+    if (bufinfo.len < width * height * 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bitmap size too small for width and height"));
+    }
+    uint16_t *s = (uint16_t *)bufinfo.buf;
+    uint16_t *d = self->frame_buffer + (y * self->width) + x;
+    if (alpha == 255) {
+        COPY_TO_BUFFER(self, s, d, width, height)
+    } else {
+        BLEND_TO_BUFFER(self, s, d, width, height, alpha)
+    }
     return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_init_obj, s3lcd_init);
 
 ///
-/// .hline(x, y, w {, color, alpha})
-/// Draw a horizontal line.
+/// .bitmap(bitmap, x, y {, alpha, index})
+/// bitmap: a bitmap module created by imgtobitmap.py utility
 /// required parameters:
-/// -- x: x coordinate
-/// -- y: y coordinate
-/// -- w: width
+/// -- x: x position
+/// -- y: y position
 /// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
+/// -- index: index of the character in the map
+/// -- alpha: alpha value (0-255)
 ///
 
-static mp_obj_t s3lcd_hline(size_t n_args, const mp_obj_t *args) {
+static mp_obj_t s3lcd_bitmap_from_module(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t x = mp_obj_get_int(args[1]);
-    mp_int_t y = mp_obj_get_int(args[2]);
-    mp_int_t w = mp_obj_get_int(args[3]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    mp_obj_module_t *bitmap = MP_OBJ_TO_PTR(args[1]);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, idx, 0)
     OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
 
-    fast_hline(self, x, y, w, color, alpha);
+    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(bitmap->globals);
+    const uint16_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
+    const uint16_t width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTH)));
+    uint16_t bitmaps = 0;
+    const uint8_t bpp = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BPP)));
+    if (bpp < 1 || bpp > 8) {
+        mp_raise_ValueError(MP_ERROR_TEXT("bitmap BPP must be 1 to 8"));
+    }
+    mp_obj_t *palette_arg = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_PALETTE));
+    mp_obj_t *palette = NULL;
+    size_t palette_len = 0;
+
+    mp_map_elem_t *elem = dict_lookup(bitmap->globals, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAPS));
+    if (elem) {
+        bitmaps = mp_obj_get_int(elem);
+    }
+
+    mp_obj_get_array(palette_arg, &palette_len, &palette);
+
+    mp_obj_t *bitmap_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAP));
+    mp_buffer_info_t bufinfo;
+
+    mp_get_buffer_raise(bitmap_data_buff, &bufinfo, MP_BUFFER_READ);
+    bitstream_t bs = {bufinfo.buf, 0};
+
+    if (bitmaps) {
+        if (idx < bitmaps) {
+            bs.bit = height * width * bpp * idx;
+        } else {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("index out of range"));
+        }
+    }
+
+    // palette colors are stored byte swapped, convert them once per call
+    uint16_t colors[256];
+    for (int i = 0; i < (1 << bpp); i++) {
+        uint16_t color = (i < palette_len) ? mp_obj_get_int(palette[i]) : 0;
+        colors[i] = _swap_bytes(color);
+    }
+
+    for (int yy = 0; yy < height; yy++) {
+        uint16_t *b = self->frame_buffer + (yy + y) * self->width + x;
+        unpack_span(&bs, bpp, b, width, colors, -1, alpha);
+    }
     return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_hline_obj, 4, 6, s3lcd_hline);
 
-///
-/// .vline(x, y, w {, color, alpha})
-/// Draw a vertical line.
-/// required parameters:
-/// -- x: x coordinate
-/// -- y: y coordinate
-/// -- w: width
-/// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
-///
+static mp_obj_t s3lcd_bitmap(size_t n_args, const mp_obj_t *args) {
+    frame_buffer_required(MP_OBJ_TO_PTR(args[0]));
 
-static mp_obj_t s3lcd_vline(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t x = mp_obj_get_int(args[1]);
-    mp_int_t y = mp_obj_get_int(args[2]);
-    mp_int_t w = mp_obj_get_int(args[3]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+    if (mp_obj_is_type(args[1], &mp_type_tuple)) {
+        return s3lcd_bitmap_from_tuple(n_args, args);
+    } else {
+        if (mp_obj_is_type(args[1], &mp_type_module)) {
+            return s3lcd_bitmap_from_module(n_args, args);
+        }
+    }
 
-    fast_vline(self, x, y, w, color, alpha);
+    mp_raise_TypeError(MP_ERROR_TEXT("bitmap requires either module or tuple."));
     return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_vline_obj, 4, 6, s3lcd_vline);
 
-// Circle/Fill_Circle by https://github.com/c-logic
-// https://github.com/russhughes/s3lcd_mpy/pull/46
-// https://github.com/c-logic/s3lcd_mpy.git patch-1
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_bitmap_obj, 4, 6, s3lcd_bitmap);
 
-///
-/// .circle(xm, ym, r {,color, alpha}])
-/// Draw a circle.
-/// required parameters:
-/// -- xm: x coordinate
-/// -- ym: y coordinate
-/// -- r: radius
-/// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
-///
+//
+// text_effects: text() with an outline or shadow.
+//
 
-static mp_obj_t s3lcd_circle(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t xm = mp_obj_get_int(args[1]);
-    mp_int_t ym = mp_obj_get_int(args[2]);
-    mp_int_t r = mp_obj_get_int(args[3]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+static void text_effects(s3lcd_obj_t *self, const uint8_t *font_data, const uint8_t *source, size_t source_len,
+    mp_int_t x, mp_int_t y, uint8_t width, uint8_t height, uint8_t first, uint8_t last,
+    mp_int_t fg, mp_int_t bg, mp_int_t alpha, mp_int_t outline, mp_int_t shadow, mp_int_t offset) {
 
-    mp_int_t f = 1 - r;
-    mp_int_t ddF_x = 1;
-    mp_int_t ddF_y = -2 * r;
-    mp_int_t x = 0;
+    mp_int_t text_width = 0;
+    for (size_t i = 0; i < source_len; i++) {
+        if (source[i] >= first && source[i] <= last) {
+            text_width += width;
+        }
+    }
+
+    if (shadow == -1) {
+        offset = 0;
+    }
+    int margin = ((outline != -1) ? 1 : 0) + offset;
+    text_mask_t mask;
+    if (!text_mask_init(&mask, self, margin, offset, x, y, text_width, height)) {
+        return;
+    }
+
+    static const uint8_t level[2] = {0, 255};
+    const size_t chr_size = height * (width / 8);
+    while (source_len--) {
+        uint8_t chr = *source++;
+        if (chr >= first && chr <= last) {
+            bitstream_t bs = {font_data + (chr - first) * chr_size, 0};
+            text_mask_glyph(&mask, NULL, &bs, 1, level, x, y, width, height);
+            x += width;
+        }
+    }
+
+    text_mask_draw(self, &mask, margin, offset, x - text_width, y, text_width, height, fg, bg, outline, shadow, alpha);
+    text_mask_free(&mask);
+}
+
+///
+/// .text(font, s, x, y {, fg, bg, alpha, outline=None, shadow=None, shadow_offset=2})
+/// Draw text on the screen using converted font module
+/// required parameters:
+/// -- font: a font module created by font2bitmap.py utility
+/// -- s: text to display
+/// -- x: x position
+/// -- y: y position
+/// optional parameters:
+/// -- fg: text color
+/// -- bg: background color
+/// -- alpha: alpha value (0-255)
+/// -- outline: color of a one pixel outline around the text
+/// -- shadow: color of a shadow down and to the right of the text
+/// -- shadow_offset: distance in pixels of the shadow, defaults to 2
+///
+
+static mp_obj_t s3lcd_text(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_font, ARG_s, ARG_x, ARG_y, ARG_fg, ARG_bg, ARG_alpha, ARG_outline, ARG_shadow, ARG_shadow_offset };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_s, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_x, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_y, MP_ARG_INT | MP_ARG_REQUIRED, {.u_int = 0}},
+        {MP_QSTR_fg, MP_ARG_INT, {.u_int = WHITE}},
+        {MP_QSTR_bg, MP_ARG_INT, {.u_int = BLACK}},
+        {MP_QSTR_alpha, MP_ARG_INT, {.u_int = 255}},
+        {MP_QSTR_outline, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_shadow, MP_ARG_OBJ | MP_ARG_KW_ONLY, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_shadow_offset, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 2}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    uint8_t single_char_s;
+    const uint8_t *source = NULL;
+    size_t source_len = 0;
+
+    // extract arguments
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(pos_args[0]);
+    frame_buffer_required(self);
+    mp_obj_module_t *font = MP_OBJ_TO_PTR(args[ARG_font].u_obj);
+    mp_obj_t text = args[ARG_s].u_obj;
+
+    if (mp_obj_is_int(text)) {
+        mp_int_t c = mp_obj_get_int(text);
+        single_char_s = (c & 0xff);
+        source = &single_char_s;
+        source_len = 1;
+    } else if (mp_obj_is_str(text)) {
+        source = (uint8_t *) mp_obj_str_get_str(text);
+        source_len = strlen((char *)source);
+    } else if (mp_obj_is_type(text, &mp_type_bytes)) {
+        mp_obj_t text_data_buff = text;
+        mp_buffer_info_t text_bufinfo;
+        mp_get_buffer_raise(text_data_buff, &text_bufinfo, MP_BUFFER_READ);
+        source = text_bufinfo.buf;
+        source_len = text_bufinfo.len;
+    } else {
+        mp_raise_TypeError(MP_ERROR_TEXT("text requires either int, str or bytes."));
+        return mp_const_none;
+    }
+
+    mp_int_t x0 = args[ARG_x].u_int;
+    mp_int_t y0 = args[ARG_y].u_int;
+
+    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(font->globals);
+    const uint8_t width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTH)));
+    const uint8_t height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
+    const uint8_t first = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FIRST)));
+    const uint8_t last = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_LAST)));
+
+    mp_obj_t font_data_buff = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT));
+    mp_buffer_info_t bufinfo;
+    mp_get_buffer_raise(font_data_buff, &bufinfo, MP_BUFFER_READ);
+    const uint8_t *font_data = bufinfo.buf;
+
+    mp_int_t fg_color = args[ARG_fg].u_int;
+    mp_int_t bg_color = args[ARG_bg].u_int;
+    mp_int_t alpha = args[ARG_alpha].u_int;
+    mp_int_t outline = effect_color(args[ARG_outline].u_obj);
+    mp_int_t shadow = effect_color(args[ARG_shadow].u_obj);
+
+    if (outline != -1 || shadow != -1) {
+        text_effects(self, font_data, source, source_len, x0, y0, width, height, first, last,
+            fg_color, bg_color, alpha, outline, shadow, effect_offset(args[ARG_shadow_offset].u_int));
+        return mp_const_none;
+    }
+
+    if (bg_color == -1 && fg_color == -1) {
+        return mp_const_none;
+    }
+
+    // index 0 is background, 1 is foreground, a transparent color is skipped
+    uint16_t palette[2] = {bg_color, fg_color};
+    int transparent = -1;
+    if (bg_color == -1) {
+        transparent = 0;
+    } else if (fg_color == -1) {
+        transparent = 1;
+    }
+
+    // clip the rows of every character to the frame buffer
+    const uint8_t wide = width / 8;
+    int top = (y0 < 0) ? -y0 : 0;
+    int bottom = (y0 + height > self->height) ? self->height - y0 : height;
+    if (top >= bottom) {
+        return mp_const_none;
+    }
+
+    while (source_len-- && x0 < (mp_int_t)self->width) {
+        uint8_t chr = *source++;
+        if (chr >= first && chr <= last) {
+            // clip the columns of the character to the frame buffer
+            int left = (x0 < 0) ? -x0 : 0;
+            int right = (x0 + width > self->width) ? self->width - x0 : width;
+            if (left < right) {
+                const uint8_t *chr_data = font_data + (chr - first) * (height * wide);
+                uint16_t *b = self->frame_buffer + x0 + left + (y0 + top) * self->width;
+                for (int line = top; line < bottom; line++) {
+                    bitstream_t bs = {chr_data + line * wide, left};
+                    unpack_span(&bs, 1, b, right - left, palette, transparent, alpha);
+                    b += self->width;
+                }
+            }
+            x0 += width;
+        }
+    }
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_text_obj, 5, s3lcd_text);
+
+static void set_rotation(s3lcd_obj_t *self) {
+
+    s3lcd_rotation_t *rotation = &self->rotations[self->rotation % self->rotations_len];
+    esp_lcd_panel_swap_xy(self->panel_handle, rotation->swap_xy);
+    esp_lcd_panel_mirror(self->panel_handle, rotation->mirror_x, rotation->mirror_y);
+    esp_lcd_panel_set_gap(self->panel_handle, rotation->x_gap, rotation->y_gap);
+
+    self->width = rotation->width;
+    self->height = rotation->height;
+}
+
+///
+/// .rotation(rotation)
+/// Set the display rotation.
+/// required parameters:
+/// -- rotation: 0=Portrait, 1=Landscape, 2=Reverse Portrait (180), 3=Reverse Landscape (180)
+///
+
+static mp_obj_t s3lcd_rotation(mp_obj_t self_in, mp_obj_t value) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t rotation = mp_obj_get_int(value) % 4;
+
+    self->rotation = rotation;
+    set_rotation(self);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(s3lcd_rotation_obj, s3lcd_rotation);
+
+///
+/// .width()
+/// Returns the width of the display in pixels.
+///
+
+static mp_obj_t s3lcd_width(mp_obj_t self_in) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(self->width);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_width_obj, s3lcd_width);
+
+///
+/// .height()
+/// Returns the height of the display in pixels.
+///
+
+static mp_obj_t s3lcd_height(mp_obj_t self_in) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_int(self->height);
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_height_obj, s3lcd_height);
+
+///
+/// .vscrdef(tfa, vsa, bfa)
+/// Set the vertical scrolling definition.
+/// required parameters:
+/// -- tfa: Top Fixed Area line
+/// -- vsa: Vertical Scrolling Area line
+/// -- bfa: Bottom Fixed Area line
+///
+
+static mp_obj_t s3lcd_vscrdef(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t tfa = mp_obj_get_int(args[1]);
+    mp_int_t vsa = mp_obj_get_int(args[2]);
+    mp_int_t bfa = mp_obj_get_int(args[3]);
+
+    uint8_t buf[6] = {(tfa) >> 8, (tfa) & 0xFF, (vsa) >> 8, (vsa) & 0xFF, (bfa) >> 8, (bfa) & 0xFF};
+    esp_lcd_panel_io_tx_param(self->io_handle, LCD_CMD_VSCRDEF, buf, 6);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_vscrdef_obj, 4, 4, s3lcd_vscrdef);
+
+///
+/// .vscsad(vssa)
+/// Set the vertical scrolling start address.
+/// required parameters:
+/// -- vssa: Vertical Scrolling Start Address
+///
+
+static mp_obj_t s3lcd_vscsad(mp_obj_t self_in, mp_obj_t vssa_in) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_int_t vssa = mp_obj_get_int(vssa_in);
+
+    uint8_t buf[2] = {(vssa) >> 8, (vssa) & 0xFF};
+    esp_lcd_panel_io_tx_param(self->io_handle, ST77XX_VSCSAD, buf, 2);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_2(s3lcd_vscsad_obj, s3lcd_vscsad);
+
+static bool lcd_panel_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
+    lcd_panel_active = false;
+    return false;
+}
+
+///
+/// .scroll(xstep, ystep{, fill=0})
+/// Scroll the framebuffer in the given direction.
+/// required parameters:
+/// -- xstep: Number of pixels to scroll in the x direction. Negative values scroll left, positive values scroll right.
+/// -- ystep: Number of pixels to scroll in the y direction. Negative values scroll up, positive values scroll down.
+/// optional parameters:
+/// -- fill: Fill color for the new pixels.
+///
+/// Based on the MicroPython framedbuffer scroll function.
+
+static mp_obj_t s3lcd_scroll(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t xstep = mp_obj_get_int(args[1]);
+    mp_int_t ystep = mp_obj_get_int(args[2]);
+    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, fill, 0)
+
+    int sx, y, xend, yend, dx, dy;
+    if (xstep < 0) {
+        sx = 0;
+        xend = self->width + xstep;
+        if (xend <= 0) {
+            return mp_const_none;
+        }
+        dx = 1;
+    } else {
+        sx = self->width - 1;
+        xend = xstep - 1;
+        if (xend >= sx) {
+            return mp_const_none;
+        }
+        dx = -1;
+    }
+    if (ystep < 0) {
+        y = 0;
+        yend = self->height + ystep;
+        if (yend <= 0) {
+            return mp_const_none;
+        }
+        dy = 1;
+    } else {
+        y = self->height - 1;
+        yend = ystep - 1;
+        if (yend >= y) {
+            return mp_const_none;
+        }
+        dy = -1;
+    }
+
+    for (; y != yend; y += dy) {
+        for (int x = sx; x != xend; x += dx) {
+            int src_x = x - xstep;
+            int src_y = y - ystep;
+            if (src_x >= 0 && src_x < self->width && src_y >= 0 && src_y < self->height) {
+                self->frame_buffer[y * self->width + x] = self->frame_buffer[src_y * self->width + src_x];
+            } else {
+                self->frame_buffer[y * self->width + x] = fill;
+            }
+        }
+    }
+
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_scroll_obj, 3, 4, s3lcd_scroll);
+
+//
+// run custom_init
+//
+
+static void custom_init(s3lcd_obj_t *self) {
+    size_t init_len;
+    mp_obj_t *init_list;
+
+    mp_obj_get_array(self->custom_init, &init_len, &init_list);
+    for (int idx = 0; idx < init_len; idx++) {
+        size_t init_cmd_len;
+        mp_obj_t *init_cmd;
+        mp_obj_get_array(init_list[idx], &init_cmd_len, &init_cmd);
+        mp_buffer_info_t init_cmd_data_info;
+        if (mp_get_buffer(init_cmd[0], &init_cmd_data_info, MP_BUFFER_READ)) {
+            uint8_t *init_cmd_data = (uint8_t *)init_cmd_data_info.buf;
+            if (init_cmd_data_info.len > 1) {
+                esp_lcd_panel_io_tx_param(self->io_handle, init_cmd_data[0], &init_cmd_data[1], init_cmd_data_info.len - 1);
+            } else {
+                esp_lcd_panel_io_tx_param(self->io_handle, init_cmd_data[0], NULL, 0);
+            }
+            mp_hal_delay_ms(10);
+            // check for delay
+            if (init_cmd_len > 1) {
+                mp_int_t delay = mp_obj_get_int(init_cmd[1]);
+                if (delay > 0) {
+                    mp_hal_delay_ms(delay);
+                }
+            }
+        }
+    }
+}
+
+
+///
+/// .init()
+/// Initialize the display, This method must be called before any other methods.
+///
+
+static mp_obj_t s3lcd_init(mp_obj_t self_in) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(self_in);
+
+    if (mp_obj_is_type(self->bus, &s3lcd_i80_bus_type)) {
+        ESP_LOGI(TAG, "Initialize Intel 8080 bus");
+        s3lcd_i80_bus_obj_t *config = MP_OBJ_TO_PTR(self->bus);
+        self->swap_color_bytes = false;
+        self->bus_handle.i80 = NULL;
+        esp_lcd_i80_bus_config_t bus_config = {
+            .dc_gpio_num = config->dc_gpio_num,
+            .wr_gpio_num = config->wr_gpio_num,
+            .clk_src = LCD_CLK_SRC_PLL160M, // same as default in IDF5 and 0 in the enum of IDF4.4
+            .data_gpio_nums = {
+                config->data_gpio_nums[0],
+                config->data_gpio_nums[1],
+                config->data_gpio_nums[2],
+                config->data_gpio_nums[3],
+                config->data_gpio_nums[4],
+                config->data_gpio_nums[5],
+                config->data_gpio_nums[6],
+                config->data_gpio_nums[7],
+            },
+            .bus_width = config->bus_width,
+            .max_transfer_bytes = self->dma_buffer_size,
+        };
+
+        ESP_ERROR_CHECK(esp_lcd_new_i80_bus(&bus_config, &self->bus_handle.i80));
+        esp_lcd_panel_io_handle_t io_handle = NULL;
+        esp_lcd_panel_io_i80_config_t io_config = {
+            .cs_gpio_num = config->cs_gpio_num,
+            .pclk_hz = config->pclk_hz,
+            .trans_queue_depth = 10,
+            .on_color_trans_done = lcd_panel_done,
+            .user_ctx = self,
+            .dc_levels = {
+                .dc_idle_level = config->dc_levels.dc_idle_level,
+                .dc_cmd_level = config->dc_levels.dc_cmd_level,
+                .dc_dummy_level = config->dc_levels.dc_dummy_level,
+                .dc_data_level = config->dc_levels.dc_data_level,
+            },
+            .lcd_cmd_bits = config->lcd_cmd_bits,
+            .lcd_param_bits = config->lcd_param_bits,
+            .flags = {
+                .cs_active_high = config->flags.cs_active_high,
+                .reverse_color_bits = config->flags.reverse_color_bits,
+                .swap_color_bytes = config->flags.swap_color_bytes,
+                .pclk_active_neg = config->flags.pclk_active_neg,
+                .pclk_idle_low = config->flags.pclk_idle_low,
+            }
+        };
+
+        ESP_ERROR_CHECK(esp_lcd_new_panel_io_i80(self->bus_handle.i80, &io_config, &io_handle));
+        self->io_handle = io_handle;
+    } else if (mp_obj_is_type(self->bus, &s3lcd_spi_bus_type)) {
+         s3lcd_spi_bus_obj_t *config = MP_OBJ_TO_PTR(self->bus);
+        self->swap_color_bytes = config->flags.swap_color_bytes;
+        spi_bus_config_t buscfg = {
+            .sclk_io_num = config->sclk_io_num,
+            .mosi_io_num = config->mosi_io_num,
+            .miso_io_num = -1,
+            .quadwp_io_num = -1,
+            .quadhd_io_num = -1,
+            .max_transfer_sz = self->dma_buffer_size
+        };
+        ESP_ERROR_CHECK(spi_bus_initialize(config->spi_host, &buscfg, SPI_DMA_CH_AUTO));
+        esp_lcd_panel_io_handle_t io_handle = NULL;
+        esp_lcd_panel_io_spi_config_t io_config = {
+            .dc_gpio_num = config->dc_gpio_num,
+            .cs_gpio_num = config->cs_gpio_num,
+            .pclk_hz = config->pclk_hz,
+            .spi_mode = 0,
+            .trans_queue_depth = 10,
+            .lcd_cmd_bits = config->lcd_cmd_bits,
+            .lcd_param_bits = config->lcd_param_bits,
+            .on_color_trans_done = lcd_panel_done,
+            .user_ctx = self,
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+            .flags.dc_as_cmd_phase = config->flags.dc_as_cmd_phase,
+#endif
+            .flags.dc_low_on_data = config->flags.dc_low_on_data,
+            .flags.octal_mode =config->flags.octal_mode,
+            .flags.lsb_first = config->flags.lsb_first
+        };
+
+        ESP_ERROR_CHECK(esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)config->spi_host, &io_config, &io_handle));
+        self->io_handle = io_handle;
+    }
+
+    esp_lcd_panel_handle_t panel_handle = NULL;
+    esp_lcd_panel_dev_config_t panel_config = {
+        .reset_gpio_num = self->rst,
+        .color_space = self->color_space,
+        .bits_per_pixel = 16,
+    };
+
+    ESP_ERROR_CHECK(esp_lcd_new_panel_st7789(self->io_handle, &panel_config, &panel_handle));
+    self->panel_handle = panel_handle;
+
+    esp_lcd_panel_reset(panel_handle);
+    if (self->custom_init == MP_OBJ_NULL) {
+        esp_lcd_panel_init(panel_handle);
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+        esp_lcd_panel_disp_on_off(panel_handle,true); //switch lcd on, not longer a part of init
+#endif
+    } else {
+        custom_init(self);
+    }
+    esp_lcd_panel_invert_color(panel_handle, self->inversion_mode);
+    set_rotation(self);
+
+    if (self->frame_buffer_size) {
+        self->frame_buffer = m_malloc(self->frame_buffer_size);
+        memset(self->frame_buffer, 0, self->frame_buffer_size);
+    }
+
+    // esp_lcd_panel_io_tx_param(self->io_handle, 0x13, NULL, 0);
+
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_init_obj, s3lcd_init);
+
+///
+/// .hline(x, y, w {, color, alpha})
+/// Draw a horizontal line.
+/// required parameters:
+/// -- x: x coordinate
+/// -- y: y coordinate
+/// -- w: width
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+///
+
+static mp_obj_t s3lcd_hline(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t x = mp_obj_get_int(args[1]);
+    mp_int_t y = mp_obj_get_int(args[2]);
+    mp_int_t w = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    fast_hline(self, x, y, w, color, alpha);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_hline_obj, 4, 6, s3lcd_hline);
+
+///
+/// .vline(x, y, w {, color, alpha})
+/// Draw a vertical line.
+/// required parameters:
+/// -- x: x coordinate
+/// -- y: y coordinate
+/// -- w: width
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+///
+
+static mp_obj_t s3lcd_vline(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t x = mp_obj_get_int(args[1]);
+    mp_int_t y = mp_obj_get_int(args[2]);
+    mp_int_t w = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    fast_vline(self, x, y, w, color, alpha);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_vline_obj, 4, 6, s3lcd_vline);
+
+// Circle/Fill_Circle by https://github.com/c-logic
+// https://github.com/russhughes/s3lcd_mpy/pull/46
+// https://github.com/c-logic/s3lcd_mpy.git patch-1
+
+//
+// circle: draw the outline of a circle centered at xm, ym.
+//
+
+static void circle(s3lcd_obj_t *self, mp_int_t xm, mp_int_t ym, mp_int_t r, uint16_t color, uint8_t alpha) {
+    mp_int_t f = 1 - r;
+    mp_int_t ddF_x = 1;
+    mp_int_t ddF_y = -2 * r;
+    mp_int_t x = 0;
+    mp_int_t y = r;
+
+    draw_pixel(self, xm, ym + r, color, alpha);
+    draw_pixel(self, xm, ym - r, color, alpha);
+    draw_pixel(self, xm + r, ym, color, alpha);
+    draw_pixel(self, xm - r, ym, color, alpha);
+    while (x < y) {
+        if (f >= 0) {
+            y -= 1;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x += 1;
+        ddF_x += 2;
+        f += ddF_x;
+        draw_pixel(self, xm + x, ym + y, color, alpha);
+        draw_pixel(self, xm - x, ym + y, color, alpha);
+        draw_pixel(self, xm + x, ym - y, color, alpha);
+        draw_pixel(self, xm - x, ym - y, color, alpha);
+        draw_pixel(self, xm + y, ym + x, color, alpha);
+        draw_pixel(self, xm - y, ym + x, color, alpha);
+        draw_pixel(self, xm + y, ym - x, color, alpha);
+        draw_pixel(self, xm - y, ym - x, color, alpha);
+    }
+}
+
+///
+/// .circle(xm, ym, r {,color, alpha}])
+/// Draw a circle.
+/// required parameters:
+/// -- xm: x coordinate
+/// -- ym: y coordinate
+/// -- r: radius
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+///
+
+static mp_obj_t s3lcd_circle(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t xm = mp_obj_get_int(args[1]);
+    mp_int_t ym = mp_obj_get_int(args[2]);
+    mp_int_t r = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    circle(self, xm, ym, r, color, alpha);
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_circle_obj, 4, 6, s3lcd_circle);
+
+//
+// isqrt: return the integer square root of n.
+//
+
+static uint32_t isqrt(uint64_t n) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > n) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+//
+// aa_circle_points: blend the eight points of a circle centered at xm, ym
+// that mirror x, y, skipping points that repeat on the axes and diagonals.
+//
+
+static void aa_circle_points(s3lcd_obj_t *self, int xm, int ym, int x, int y, uint16_t color, uint8_t coverage) {
+    blend_pixel(self, xm + x, ym + y, color, coverage);
+    blend_pixel(self, xm + x, ym - y, color, coverage);
+    if (x) {
+        blend_pixel(self, xm - x, ym + y, color, coverage);
+        blend_pixel(self, xm - x, ym - y, color, coverage);
+    }
+    if (x != y) {
+        blend_pixel(self, xm + y, ym + x, color, coverage);
+        blend_pixel(self, xm - y, ym + x, color, coverage);
+        if (x) {
+            blend_pixel(self, xm + y, ym - x, color, coverage);
+            blend_pixel(self, xm - y, ym - x, color, coverage);
+        }
+    }
+}
+
+//
+// aa_circle: draw an anti-aliased circle centered at xm, ym.
+//
+
+static void aa_circle(s3lcd_obj_t *self, mp_int_t xm, mp_int_t ym, mp_int_t r, uint16_t color, uint8_t alpha) {
+    if (r < 0 || xm + r + 1 < 0 || ym + r + 1 < 0 || xm - r - 1 >= self->width || ym - r - 1 >= self->height) {
+        return;
+    }
+
+    // for each x in the first octant, y = sqrt(r * r - x * x) in 24.8 fixed-point
+    for (int64_t x = 0; x <= r; x++) {
+        uint32_t y_fixed = isqrt((uint64_t)((int64_t)r * r - x * x) << 16);
+        int y = y_fixed >> 8;
+        if (x > y) {
+            break;
+        }
+        uint8_t weight = y_fixed & 0xff;
+        aa_circle_points(self, xm, ym, x, y, color, (255 - weight) * alpha / 255);
+        aa_circle_points(self, xm, ym, x, y + 1, color, weight * alpha / 255);
+    }
+}
+
+///
+/// .aa_circle(xm, ym, r {,color, alpha}])
+/// Draw an anti-aliased circle.
+/// required parameters:
+/// -- xm: x coordinate
+/// -- ym: y coordinate
+/// -- r: radius
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+///
+
+static mp_obj_t s3lcd_aa_circle(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t xm = mp_obj_get_int(args[1]);
+    mp_int_t ym = mp_obj_get_int(args[2]);
+    mp_int_t r = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    aa_circle(self, xm, ym, r, color, alpha);
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_aa_circle_obj, 4, 6, s3lcd_aa_circle);
+
+// Circle/Fill_Circle by https://github.com/c-logic
+// https://github.com/russhughes/s3lcd_mpy/pull/46
+// https://github.com/c-logic/s3lcd_mpy.git patch-1
+
+//
+// fill_circle: draw a filled circle centered at xm, ym.
+//
+
+static void fill_circle(s3lcd_obj_t *self, mp_int_t xm, mp_int_t ym, mp_int_t r, uint16_t color, uint8_t alpha) {
+    mp_int_t f = 1 - r;
+    mp_int_t ddF_x = 1;
+    mp_int_t ddF_y = -2 * r;
+    mp_int_t x = 0;
     mp_int_t y = r;
 
-    draw_pixel(self, xm, ym + r, color, alpha);
-    draw_pixel(self, xm, ym - r, color, alpha);
-    draw_pixel(self, xm + r, ym, color, alpha);
-    draw_pixel(self, xm - r, ym, color, alpha);
-    while (x < y) {
-        if (f >= 0) {
-            y -= 1;
-            ddF_y += 2;
-            f += ddF_y;
+    fast_vline(self, xm, ym - y, 2 * y + 1, color, alpha);
+
+    while (x < y) {
+        if (f >= 0) {
+            y -= 1;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x += 1;
+        ddF_x += 2;
+        f += ddF_x;
+        fast_vline(self, xm + x, ym - y, 2 * y + 1, color, alpha);
+        fast_vline(self, xm + y, ym - x, 2 * x + 1, color, alpha);
+        fast_vline(self, xm - x, ym - y, 2 * y + 1, color, alpha);
+        fast_vline(self, xm - y, ym - x, 2 * x + 1, color, alpha);
+    }
+}
+
+///
+/// .fill_circle(xm, ym, r {,color, alpha})
+/// Draw a filled circle.
+/// required parameters:
+/// -- xm: x coordinate
+/// -- ym: y coordinate
+/// -- r: radius
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+///
+
+static mp_obj_t s3lcd_fill_circle(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t xm = mp_obj_get_int(args[1]);
+    mp_int_t ym = mp_obj_get_int(args[2]);
+    mp_int_t r = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    fill_circle(self, xm, ym, r, color, alpha);
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_fill_circle_obj, 4, 6, s3lcd_fill_circle);
+
+//
+// rect: draw the outline of a w by h rectangle.
+//
+
+static void rect(s3lcd_obj_t *self, mp_int_t x, mp_int_t y, mp_int_t w, mp_int_t h, uint16_t color, uint8_t alpha) {
+    fast_hline(self, x, y, w, color, alpha);
+    fast_vline(self, x, y, h, color, alpha);
+    fast_hline(self, x, y + h - 1, w, color, alpha);
+    fast_vline(self, x + w - 1, y, h, color, alpha);
+}
+
+///
+/// .rect(x, y, w, h {, color, alpha})
+/// Draw a rectangle.
+/// required parameters:
+/// -- x: x coordinate
+/// -- y: y coordinate
+/// -- w: width
+/// -- h: height
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+///
+
+static mp_obj_t s3lcd_rect(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t x = mp_obj_get_int(args[1]);
+    mp_int_t y = mp_obj_get_int(args[2]);
+    mp_int_t w = mp_obj_get_int(args[3]);
+    mp_int_t h = mp_obj_get_int(args[4]);
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, alpha, 255)
+
+    rect(self, x, y, w, h, color, alpha);
+    return mp_const_none;
+}
+
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_rect_obj, 5, 7, s3lcd_rect);
+
+///
+/// .color565(r, g, b)
+/// Convert RGB888 to RGB565.
+/// required parameters:
+/// -- r: red
+/// -- g: green
+/// -- b: blue
+///
+
+static mp_obj_t s3lcd_color565(mp_obj_t r, mp_obj_t g, mp_obj_t b) {
+    return MP_OBJ_NEW_SMALL_INT(color565(
+        (uint8_t)mp_obj_get_int(r),
+        (uint8_t)mp_obj_get_int(g),
+        (uint8_t)mp_obj_get_int(b)));
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(s3lcd_color565_obj, s3lcd_color565);
+
+static void map_bitarray_to_rgb565(uint8_t const *bitarray, uint16_t *buffer, int length, int width,
+    uint16_t color, uint16_t bg_color) {
+    int row_pos = 0;
+    for (int i = 0; i < length; i++) {
+        uint8_t byte = bitarray[i];
+        for (int bi = 7; bi >= 0; bi--) {
+            uint8_t b = byte & (1 << bi);
+            uint16_t cur_color = b ? color : bg_color;
+            *buffer++ = cur_color;
+            row_pos++;
+            if (row_pos >= width) {
+                row_pos = 0;
+                break;
+            }
+        }
+    }
+}
+
+///
+/// .map_bitarray_to_rgb565(bitarray, buffer, width {, color, bg_color})
+/// Map a bitarray to a buffer of RGB565 pixels.
+/// required parameters:
+/// -- bitarray: bitarray
+/// -- buffer: buffer
+/// -- width: width
+/// optional parameters:
+/// -- color: color
+/// -- bg_color: background color
+///
+
+static mp_obj_t s3lcd_map_bitarray_to_rgb565(size_t n_args, const mp_obj_t *args) {
+    mp_buffer_info_t bitarray_info;
+    mp_buffer_info_t buffer_info;
+
+    mp_get_buffer_raise(args[1], &bitarray_info, MP_BUFFER_READ);
+    mp_get_buffer_raise(args[2], &buffer_info, MP_BUFFER_WRITE);
+    mp_int_t width = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, bg_color, BLACK)
+
+    map_bitarray_to_rgb565(bitarray_info.buf, buffer_info.buf, bitarray_info.len, width, color, bg_color);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_map_bitarray_to_rgb565_obj, 3, 7, s3lcd_map_bitarray_to_rgb565);
+
+//
+// Direct drawing sends rows of pixels straight to the display without a
+// framebuffer. Rows are collected in one of the two dma buffers while the
+// other is being sent.
+//
+
+typedef struct _direct_t {
+    s3lcd_obj_t *self;                      // display object
+    uint16_t *buffers[2];                   // dma buffers
+    int buffer;                             // buffer rows are collected in
+    int left;                               // first display column sent
+    int width;                              // number of columns sent
+    int rows;                               // rows that fit in a buffer
+} direct_t;
+
+static void direct_init(direct_t *direct, s3lcd_obj_t *self, int left, int width) {
+    if (self->strip_buffer == NULL) {
+        self->strip_buffer = heap_caps_malloc(self->dma_buffer_size, MALLOC_CAP_DMA);
+        if (self->strip_buffer == NULL) {
+            mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate DMA buffer"));
+        }
+    }
+    direct->self = self;
+    direct->buffers[0] = self->dma_buffer;
+    direct->buffers[1] = self->strip_buffer;
+    direct->buffer = 0;
+    direct->left = left;
+    direct->width = width;
+    direct->rows = (width > 0) ? self->dma_buffer_size / (width * sizeof(uint16_t)) : 0;
+}
+
+//
+// direct_send: send rows of pixels from the current buffer to the display
+// starting at row top, then switch to the other buffer.
+//
+
+static void direct_send(direct_t *direct, int top, int rows, uint16_t *pixels) {
+    s3lcd_obj_t *self = direct->self;
+    if (self->swap_color_bytes) {
+        for (size_t i = 0; i < (size_t)rows * direct->width; i++) {
+            pixels[i] = _swap_bytes(pixels[i]);
+        }
+    }
+
+    // wait for the previous rows before sending these
+    while (lcd_panel_active) {
+    }
+    lcd_panel_active = true;
+    esp_lcd_panel_draw_bitmap(self->panel_handle, direct->left, top, direct->left + direct->width, top + rows, pixels);
+    direct->buffer ^= 1;
+}
+
+static void direct_done(direct_t *direct) {
+    while (lcd_panel_active) {
+    }
+}
+
+//
+// jpg routines
+//
+
+// User defined device identifier
+typedef struct {
+    mp_file_t *fp;                      // File pointer for input function
+    uint8_t *fbuf;                      // Pointer to the frame buffer for output function
+    uint16_t wfbuf;                     // Width of the frame buffer [pix]
+    uint16_t left;                      // jpg crop left column
+    uint16_t top;                       // jpg crop top row
+    uint16_t right;                     // jpg crop right column
+    uint16_t bottom;                    // jpg crop bottom row
+
+    s3lcd_obj_t *self;                  // display object
+    direct_t *direct;                   // rows sent to the display or NULL
+
+    uint8_t *data;                      // Pointer to the input data
+    uint32_t dataIdx;                   // Index of the input data
+    uint32_t dataLen;                   // Length of the input data
+
+} IODEV;
+
+//
+// buffer input function
+//
+
+static unsigned int buffer_in_func(     // Returns number of bytes read (zero on error)
+    JDEC *jd,                           // Decompression object
+    uint8_t *buff,                      // Pointer to the read buffer (null to remove data)
+    unsigned int nbyte) {               // Number of bytes to read/remove
+    IODEV *dev = (IODEV *)jd->device;
+
+    if (dev->dataIdx + nbyte > dev->dataLen) {
+        nbyte = dev->dataLen - dev->dataIdx;
+    }
+
+    if (buff) {
+        memcpy(buff, (uint8_t *)(dev->data + dev->dataIdx), nbyte);
+    }
+
+    dev->dataIdx += nbyte;
+    return nbyte;
+}
+
+
+//
+// file input function
+//
+
+static unsigned int file_in_func(           // Returns number of bytes read (zero on error)
+    JDEC *jd,                               // Decompression object
+    uint8_t *buff,                          // Pointer to the read buffer (null to remove data)
+    unsigned int nbyte) {                   // Number of bytes to read/remove
+    IODEV *dev = (IODEV *)jd->device;       // Device identifier for the session (5th argument of jd_prepare function)
+    unsigned int nread;
+
+    if (buff) {                             // Read data from input stream
+        nread = (unsigned int)mp_readinto(dev->fp, buff, nbyte);
+        return nread;
+    }
+
+    // Remove data from input stream if buff was NULL
+    mp_seek(dev->fp, nbyte, SEEK_CUR);
+    return 0;
+}
+
+//
+// jpg output function
+//
+
+static int jpg_out(                                         // 1:Ok, 0:Aborted
+    JDEC *jd,                                               // Decompression object
+    void *bitmap,                                           // Bitmap data to be output
+    JRECT *rect) {                                          // Rectangular region of output image
+    IODEV *dev = (IODEV *)jd->device;
+    uint16_t wd = dev->wfbuf;
+    uint16_t ws = rect->right - rect->left + 1;
+    uint16_t stride = wd - ws;
+
+    // Copy the decompressed RGB rectangular to the frame buffer (assuming RGB565)
+    uint16_t *src = (uint16_t *) bitmap;
+    uint16_t *dst = (uint16_t *) dev->fbuf + ((rect->top + jd->y_offs) * dev->wfbuf + rect->left + jd->x_offs);
+
+    for (int y = rect->top; y <= rect->bottom; y++) {
+        for (int x = rect->left; x <= rect->right; x++) {
+            if ( x+jd->x_offs < 0 || x+jd->x_offs >= dev->self->width || y+jd->y_offs < 0 || y+jd->y_offs >= dev->self->height) {
+                src++;
+                dst++;
+            }
+            else {
+                *dst++ = *src++;
+            }
+        }
+        dst += stride;
+    }
+    return 1;
+}
+
+//
+// jpg_out_direct: jpg output function that collects each row of MCUs in a
+// dma buffer and sends the visible rows to the display after the last MCU
+// of the row.
+//
+
+static int jpg_out_direct(JDEC *jd, void *bitmap, JRECT *rect) {
+    IODEV *dev = (IODEV *)jd->device;
+    direct_t *direct = dev->direct;
+    uint16_t *rows = direct->buffers[direct->buffer];
+    uint16_t *src = (uint16_t *)bitmap;
+
+    for (int y = rect->top; y <= rect->bottom; y++) {
+        uint16_t *dst = rows + (y - rect->top) * direct->width - direct->left;
+        for (int x = rect->left; x <= rect->right; x++) {
+            int col = x + jd->x_offs;
+            if (col >= direct->left && col < direct->left + direct->width) {
+                dst[col] = *src;
+            }
+            src++;
+        }
+    }
+
+    if (rect->right == jd->width - 1) {
+        int top = rect->top + jd->y_offs;
+        int first = (top < 0) ? 0 : top;
+        int last = rect->bottom + jd->y_offs + 1;
+        if (last > dev->self->height) {
+            last = dev->self->height;
+        }
+        if (first < last) {
+            direct_send(direct, first, last - first, rows + (first - top) * direct->width);
+        }
+    }
+    return 1;
+}
+
+///
+/// .jpg(filename, x, y {, direct})
+/// Draw jpg from a file at x, y
+/// required parameters:
+/// -- filename: filename
+/// -- x: x
+/// -- y: y
+/// optional parameters:
+/// -- direct: send the image straight to the display instead of drawing it
+///    in the framebuffer, defaults to True without a framebuffer
+
+static mp_obj_t s3lcd_jpg(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, bool, mp_obj_is_true, direct, self->frame_buffer == NULL)
+    if (!direct) {
+        frame_buffer_required(self);
+    }
+
+    JRESULT res = JDR_OK;                           // Result code of TJpgDec API
+    JDEC jdec;                                      // Decompression object
+    IODEV devid;                                    // User defined device identifier
+    static unsigned int (*input_func)(JDEC *, uint8_t *, unsigned int) = NULL;
+
+    if (mp_obj_is_type(args[1], &mp_type_bytes)) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+        devid.dataIdx = 0;
+        devid.data = bufinfo.buf;
+        devid.dataLen = bufinfo.len;
+        input_func = buffer_in_func;
+        self->fp = MP_OBJ_NULL;
+    } else {
+        const char *filename = mp_obj_str_get_str(args[1]);
+        self->fp = mp_open(filename, "rb");
+        devid.fp = self->fp;
+        input_func = file_in_func;
+        devid.data = MP_OBJ_NULL;
+        devid.dataLen = 0;
+    }
+
+    // errors are raised once the file and work area are released
+    const mp_obj_type_t *error_type = NULL;
+    mp_rom_error_text_t error = NULL;
+    self->work = (void *)m_malloc(3100);            // Pointer to the work area
+    if (devid.fp || devid.data) {
+        jdec.x_offs = x;
+        jdec.y_offs = y;
+        // Prepare to decompress
+        res = jd_prepare(&jdec, input_func, self->work, 3100, &devid);
+        if (res == JDR_OK) {
+            // Initialize output device
+            devid.fbuf = (uint8_t *)self->frame_buffer;
+            devid.wfbuf = self->width;
+            devid.self = self;
+            devid.direct = NULL;
+            if (direct) {
+                int left = (x < 0) ? 0 : x;
+                int right = (x + jdec.width > self->width) ? self->width : x + jdec.width;
+                direct_t rows;
+                direct_init(&rows, self, left, right - left);
+                if (left < right && rows.rows < jdec.msy * 8) {
+                    error_type = &mp_type_ValueError;
+                    error = MP_ERROR_TEXT("dma_rows too small to draw jpg directly");
+                } else {
+                    devid.direct = &rows;
+                    res = (left < right) ? jd_decomp(&jdec, jpg_out_direct, 0) : JDR_OK;
+                    direct_done(&rows);
+                }
+            } else {
+                res = jd_decomp(&jdec, jpg_out, 0);     // Start to decompress with 1/1 scaling
+            }
+            if (error == NULL && res != JDR_OK) {
+                error_type = &mp_type_RuntimeError;
+                error = MP_ERROR_TEXT("jpg decompress failed: %d.");
+            }
+        } else {
+            error_type = &mp_type_RuntimeError;
+            error = MP_ERROR_TEXT("jpg prepare failed: %d.");
+        }
+        if (self->fp) {
+            mp_close(self->fp);
+            self->fp = MP_OBJ_NULL;
+        }
+    }
+    m_free(self->work);     // Discard work area
+    self->work = NULL;
+
+    if (error) {
+        mp_raise_msg_varg(error_type, error, res);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_jpg_obj, 4, 5, s3lcd_jpg);
+
+//
+// output function for jpg_decode
+//
+
+static int out_crop(                                // 1:Ok, 0:Aborted
+    JDEC *jd,                                       // Decompression object
+    void *bitmap,                                   // Bitmap data to be output
+    JRECT *rect) {                                  // Rectangular region of output image
+    IODEV *dev = (IODEV *)jd->device;
+
+    if (dev->left <= rect->right &&
+        dev->right >= rect->left &&
+        dev->top <= rect->bottom &&
+        dev->bottom >= rect->top) {
+        uint16_t left = MAX(dev->left, rect->left);
+        uint16_t top = MAX(dev->top, rect->top);
+        uint16_t right = MIN(dev->right, rect->right);
+        uint16_t bottom = MIN(dev->bottom, rect->bottom);
+        uint16_t dev_width = dev->right - dev->left + 1;
+        uint16_t rect_width = rect->right - rect->left + 1;
+        uint16_t width = (right - left + 1) * 2;
+        uint16_t row;
+
+        for (row = top; row <= bottom; row++) {
+            memcpy(
+                (uint16_t *)dev->fbuf + ((row - dev->top) * dev_width) + left - dev->left,
+                (uint16_t *)bitmap + ((row - rect->top) * rect_width) + left - rect->left,
+                width);
+        }
+    }
+    return 1;   // Continue to decompress
+}
+
+///
+/// .jpg_decode(filename {, x, y, width, height})
+/// Decode a jpg file and return it or a portion of it as a tuple containing a blittable buffer,
+/// the width and height of the buffer.
+/// required parameters:
+/// -- filename: filename
+/// optional parameters:
+/// -- x: x
+/// -- y: y
+/// -- width: width
+/// -- height: height
+///
+
+static mp_obj_t s3lcd_jpg_decode(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    const char *filename = NULL;
+
+    if (n_args == 2 || n_args == 6) {
+        OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, x, 0)
+        OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, y, 0)
+        OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, width, -1)
+        OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, height, -1)
+
+        self->work = (void *)m_malloc(3100);        // Pointer to the work area
+        JRESULT res;                                // Result code of TJpgDec API
+        JDEC jdec;                                  // Decompression object
+        IODEV devid;                                // User defined device identifier
+        size_t bufsize = 0;
+        static unsigned int (*input_func)(JDEC *, uint8_t *, unsigned int) = NULL;
+
+        if (mp_obj_is_type(args[1], &mp_type_bytes)) {
+            mp_buffer_info_t bufinfo;
+            mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+            devid.dataIdx = 0;
+            devid.data = bufinfo.buf;
+            devid.dataLen = bufinfo.len;
+            input_func = buffer_in_func;
+            self->fp = MP_OBJ_NULL;
+        } else {
+            filename = mp_obj_str_get_str(args[1]);
+            self->fp = mp_open(filename, "rb");
+            devid.fp = self->fp;
+            input_func = file_in_func;
+            devid.data = MP_OBJ_NULL;
+            devid.dataLen = 0;
+        }
+
+        if (devid.fp || devid.data) {
+            // Prepare to decompress
+            res = jd_prepare(&jdec, input_func, self->work, 3100, &devid);
+            if (res == JDR_OK) {
+                if (n_args < 6) {
+                    x = 0;
+                    y = 0;
+                    width = jdec.width;
+                    height = jdec.height;
+                }
+
+                if (width == -1) {
+                    width = jdec.width;
+                }
+
+                if (height == -1) {
+                    height = jdec.height;
+                }
+
+                // Initialize output device
+                devid.left = x;
+                devid.top = y;
+                devid.right = x + width - 1;
+                devid.bottom = y + height - 1;
+
+                bufsize = 2 * width * height;
+                self->work_buffer = m_malloc(bufsize);
+                if (self->work_buffer) {
+                    memset(self->work_buffer, 0, bufsize);
+                } else {
+                    mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("out of memory"));
+                }
+
+                devid.fbuf = (uint8_t *)self->work_buffer;
+                devid.wfbuf = width;
+                devid.self = self;
+                res = jd_decomp(&jdec, out_crop, 0);
+                if (res != JDR_OK) {
+                    mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg decompress failed: %d."), res);
+                }
+            } else {
+                mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg prepare failed: %d."), res);
+            }
+
+            if (self->fp) {
+                mp_close(self->fp);
+                self->fp = MP_OBJ_NULL;
+            }
+
+            m_free(self->work);                         // Discard work area
+
+            mp_obj_t result[3] = {
+                mp_obj_new_bytearray(bufsize, (mp_obj_t *)self->work_buffer),
+                mp_obj_new_int(width),
+                mp_obj_new_int(height)
+            };
+
+            return mp_obj_new_tuple(3, result);
+            self->work_buffer = NULL;
+        }
+    } else {
+        mp_raise_TypeError(MP_ERROR_TEXT("jpg_decode requires either 1 or 5 arguments"));
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_jpg_decode_obj, 2, 6, s3lcd_jpg_decode);
+
+//
+// PNG Routines using the pngle library from https://github.com/kikuchan/pngle
+// licensed under the MIT License
+//
+
+typedef struct _PNG_USER_DATA {
+    s3lcd_obj_t *self;
+    int16_t top;                                   // draw png starting at this row
+    int16_t left;                                  // draw png starting at this column
+    int16_t fg_color;                              // override foreground color
+    direct_t *direct;                              // rows sent to the display or NULL
+    int rows_top;                                  // display row of the first collected row, -1 if none
+    int rows_last;                                 // display row of the last collected row
+    mp_rom_error_text_t error;                     // error found by a callback, stops the decode
+} PNG_USER_DATA;
+
+//
+// png_on_draw_direct: collect the visible rows of a png in a dma buffer,
+// blending transparent pixels with black, and send the rows to the display
+// when the buffer is full.
+//
+
+static void png_on_draw_direct(PNG_USER_DATA *user_data, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint8_t rgba[4]) {
+    direct_t *direct = user_data->direct;
+    int col = x + user_data->left - direct->left;
+    int row = y + user_data->top;
+    if (col < 0 || col >= direct->width || row < 0 || row >= user_data->self->height) {
+        return;
+    }
+
+    if (user_data->rows_top >= 0 && row - user_data->rows_top >= direct->rows) {
+        direct_send(direct, user_data->rows_top, user_data->rows_last - user_data->rows_top + 1, direct->buffers[direct->buffer]);
+        user_data->rows_top = -1;
+    }
+    if (user_data->rows_top < 0) {
+        user_data->rows_top = row;
+        memset(direct->buffers[direct->buffer], 0, direct->rows * direct->width * sizeof(uint16_t));
+    }
+    user_data->rows_last = row;
+
+    uint16_t color = color565(rgba[0], rgba[1], rgba[2]);
+    direct->buffers[direct->buffer][(row - user_data->rows_top) * direct->width + col] = alpha_blend_565(color, BLACK, rgba[3]);
+}
+
+//
+// png_on_init_direct: reject interlaced images before any rows are decoded
+// and send only the visible columns of the image. Errors are raised by
+// s3lcd_png once the decoder and file are released.
+//
+
+static void png_on_init_direct(pngle_t *pngle, uint32_t w, uint32_t h) {
+    PNG_USER_DATA *user_data = pngle_get_user_data(pngle);
+    if (pngle_get_ihdr(pngle)->interlace) {
+        user_data->error = MP_ERROR_TEXT("interlaced png can not be drawn directly");
+        return;
+    }
+
+    s3lcd_obj_t *self = user_data->self;
+    int left = (user_data->left < 0) ? 0 : user_data->left;
+    int right = (user_data->left + (int)w > self->width) ? self->width : user_data->left + (int)w;
+    direct_init(user_data->direct, self, left, (left < right) ? right - left : 0);
+}
+
+void pngle_on_draw(pngle_t *pngle, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint8_t rgba[4]) {
+    PNG_USER_DATA *user_data = pngle_get_user_data(pngle);
+    s3lcd_obj_t *self = user_data->self;
+
+    if (user_data->error) {
+        return;
+    }
+    if (user_data->direct) {
+        png_on_draw_direct(user_data, x, y, w, h, rgba);
+        return;
+    }
+
+    if ( x+user_data->left >= self->width || y+user_data->top >= self->height) {
+        return;
+    }
+
+    uint16_t color = (color565(rgba[0], rgba[1], rgba[2]));
+    _fill_rect(self, x + user_data->left, y + user_data->top, w, h, color, rgba[3]);
+}
+
+///
+/// .png(filename, x, y {, direct})
+/// Draw a PNG image on the display
+/// required parameters:
+/// -- filename: the name of the file to load
+/// -- x: the x coordinate to draw the image
+/// -- y: the y coordinate to draw the image
+/// optional parameters:
+/// -- direct: send the image straight to the display instead of drawing it
+///    in the framebuffer, defaults to True without a framebuffer
+///
+
+static mp_obj_t s3lcd_png(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, bool, mp_obj_is_true, direct, self->frame_buffer == NULL)
+    if (!direct) {
+        frame_buffer_required(self);
+    }
+
+    char read_buf[512];
+    char *buf = (char *)self->dma_buffer; // Reuse the dma_buffer
+    size_t buf_size = self->dma_buffer_size;
+    int len, remain = 0;
+
+    PNG_USER_DATA user_data = {
+        self, y, x
+    };
+    user_data.error = NULL;
+
+    // the dma buffers collect rows when drawing directly, the columns are
+    // set when the image size is known
+    direct_t rows;
+    if (direct) {
+        direct_init(&rows, self, 0, 0);
+        user_data.direct = &rows;
+        user_data.rows_top = -1;
+        buf = read_buf;
+        buf_size = sizeof(read_buf);
+    }
+
+    // allocate new pngle_t and store in self to protect memory from gc
+    self->work = pngle_new(self);
+    pngle_t *pngle = (pngle_t *)self->work;
+    pngle_set_user_data(pngle, (void *)&user_data);
+    pngle_set_draw_callback(pngle, pngle_on_draw);
+    if (direct) {
+        pngle_set_init_callback(pngle, png_on_init_direct);
+    }
+
+    // stop at the first error, then release the file and decoder before
+    // raising it
+    int fed = 0;
+    if (mp_obj_is_type(args[1], &mp_type_bytes)) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
+        fed = pngle_feed(pngle, bufinfo.buf, bufinfo.len);
+    } else {
+        const char *filename = mp_obj_str_get_str(args[1]);
+        self->fp = mp_open(filename, "rb");
+        while ((len = mp_readinto(self->fp, buf + remain, buf_size - remain)) > 0) {
+            fed = pngle_feed(pngle, buf, remain + len);
+            if (fed < 0 || user_data.error) {
+                break;
+            }
+            remain = remain + len - fed;
+            if (remain > 0) {
+                memmove(buf, buf + fed, remain);
+            }
+        }
+        mp_close(self->fp);
+        self->fp = MP_OBJ_NULL;
+    }
+    const char *decode_error = (fed < 0) ? pngle_error(pngle) : NULL;
+    pngle_destroy(pngle);
+    self->work = NULL;
+
+    if (direct) {
+        if (user_data.rows_top >= 0 && !user_data.error && !decode_error) {
+            direct_send(&rows, user_data.rows_top, user_data.rows_last - user_data.rows_top + 1, rows.buffers[rows.buffer]);
+        }
+        direct_done(&rows);
+    }
+    if (user_data.error) {
+        mp_raise_ValueError(user_data.error);
+    }
+    if (decode_error) {
+        mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("png decompress failed: %s"), decode_error);
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_png_obj, 4, 5, s3lcd_png);
+
+//
+//  png_write fileio callback functions
+//
+
+int32_t pngWrite(PNGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
+    return mp_write((mp_file_t *) pFile->fHandle,  pBuf, iLen);
+}
+
+int32_t pngRead(PNGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
+    return mp_readinto((mp_file_t *) pFile->fHandle, pBuf, iLen);
+}
+
+int32_t pngSeek(PNGFILE *pFile, int32_t iPosition) {
+    return mp_seek((mp_file_t *) pFile->fHandle, iPosition, SEEK_SET);
+}
+
+void *pngOpen(const char *szFilename) {
+    return (void *)mp_open(szFilename, "w+b");
+}
+
+void pngClose(PNGFILE *pFile) {
+    mp_close((mp_file_t *) pFile->fHandle);
+}
+
+//
+// .png_write(file_name{ x, y, width, height})
+//
+// save the framebuffer to a png file using PNGenc from
+// https://github.com/bitbank2/PNGenc
+//
+//  required parameters:
+//  -- filename: the name of the file to save
+//  optional parameters:
+//  -- x: the x coordinate to start saving
+//  -- y: the y coordinate to start saving
+//  -- width: the width of the area to save
+//  -- height: the height of the area to save
+//  returns:
+//  -- file size in bytes
+//
+
+static mp_obj_t s3lcd_png_write(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    const char *filename = mp_obj_str_get_str(args[1]);
+    int data_size = 0;
+    int work_buffer_size = self->width * 3 * 2;
+    int rc;
+
+    if (n_args == 2 || n_args == 6) {
+        OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, x, 0)
+        OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, y, 0)
+        OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, width, self->width)
+        OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, height, self->height)
+
+        if (x >= 0 && x + width <= self->width &&
+            y >= 0 && y + height <= self->height) {
+
+            PNGIMAGE *pPNG = (PNGIMAGE *) m_malloc(sizeof(PNGIMAGE));
+            if (pPNG == NULL) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("memory allocation failed"));
+            }
+            self->work = pPNG;
+
+            self->work_buffer = (uint16_t *) m_malloc(work_buffer_size);
+            if (self->work_buffer == NULL) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("memory allocation failed"));
+            }
+
+            rc = PNG_openFile(pPNG, filename, pngOpen, pngClose, pngRead, pngWrite, pngSeek);
+            if (rc != PNG_SUCCESS) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Error opening output file"));
+            }
+
+            rc = PNG_encodeBegin(pPNG, width, height, PNG_PIXEL_TRUECOLOR, 24, NULL, 9);
+            if (rc == PNG_SUCCESS) {
+                uint16_t *p = self->frame_buffer + x + self->width * y;
+                for (int row = y; row <= y+height && rc == PNG_SUCCESS; row++) {
+                    rc = PNG_addRGB565Line(pPNG, p, self->work_buffer, row-y);
+                    p += self->width;
+                }
+                data_size = PNG_close(pPNG);
+            }
+            m_free(pPNG);
+            self->work = NULL;
+            m_free(self->work_buffer);
+            self->work_buffer = NULL;
         }
-        x += 1;
-        ddF_x += 2;
-        f += ddF_x;
-        draw_pixel(self, xm + x, ym + y, color, alpha);
-        draw_pixel(self, xm - x, ym + y, color, alpha);
-        draw_pixel(self, xm + x, ym - y, color, alpha);
-        draw_pixel(self, xm - x, ym - y, color, alpha);
-        draw_pixel(self, xm + y, ym + x, color, alpha);
-        draw_pixel(self, xm - y, ym + x, color, alpha);
-        draw_pixel(self, xm + y, ym - x, color, alpha);
-        draw_pixel(self, xm - y, ym - x, color, alpha);
+    } else {
+        mp_raise_TypeError(MP_ERROR_TEXT("jpg_write requires either 1 or 5 arguments"));
     }
-    return mp_const_none;
-}
-
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_circle_obj, 4, 6, s3lcd_circle);
 
-// Circle/Fill_Circle by https://github.com/c-logic
-// https://github.com/russhughes/s3lcd_mpy/pull/46
-// https://github.com/c-logic/s3lcd_mpy.git patch-1
+    return mp_obj_new_int(data_size);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_png_write_obj, 2, 6, s3lcd_png_write);
 
 ///
-/// .fill_circle(xm, ym, r {,color, alpha})
-/// Draw a filled circle.
+/// .polygon_center(polygon)
+/// Return the center of a polygon as an (x, y) tuple
 /// required parameters:
-/// -- xm: x coordinate
-/// -- ym: y coordinate
-/// -- r: radius
-/// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
+/// -- polygon: a list of (x, y) tuples
 ///
 
-static mp_obj_t s3lcd_fill_circle(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t xm = mp_obj_get_int(args[1]);
-    mp_int_t ym = mp_obj_get_int(args[2]);
-    mp_int_t r = mp_obj_get_int(args[3]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+static mp_obj_t s3lcd_polygon_center(size_t n_args, const mp_obj_t *args) {
+    size_t poly_len;
+    mp_obj_t *polygon;
+    mp_obj_get_array(args[1], &poly_len, &polygon);
 
-    mp_int_t f = 1 - r;
-    mp_int_t ddF_x = 1;
-    mp_int_t ddF_y = -2 * r;
-    mp_int_t x = 0;
-    mp_int_t y = r;
+    mp_float_t sum = 0.0;
+    int vsx = 0;
+    int vsy = 0;
 
-    fast_vline(self, xm, ym - y, 2 * y + 1, color, alpha);
+    if (poly_len > 0) {
+        for (int idx = 0; idx < poly_len; idx++) {
+            size_t point_from_poly_len;
+            mp_obj_t *point_from_poly;
+            mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
+            if (point_from_poly_len < 2) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            }
 
-    while (x < y) {
-        if (f >= 0) {
-            y -= 1;
-            ddF_y += 2;
-            f += ddF_y;
+            mp_int_t v1x = mp_obj_get_int(point_from_poly[0]);
+            mp_int_t v1y = mp_obj_get_int(point_from_poly[1]);
+
+            mp_obj_get_array(polygon[(idx + 1) % poly_len], &point_from_poly_len, &point_from_poly);
+            if (point_from_poly_len < 2) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            }
+
+            mp_int_t v2x = mp_obj_get_int(point_from_poly[0]);
+            mp_int_t v2y = mp_obj_get_int(point_from_poly[1]);
+
+            mp_float_t cross = v1x * v2y - v1y * v2x;
+            sum += cross;
+            vsx += (int)((v1x + v2x) * cross);
+            vsy += (int)((v1y + v2y) * cross);
         }
-        x += 1;
-        ddF_x += 2;
-        f += ddF_x;
-        fast_vline(self, xm + x, ym - y, 2 * y + 1, color, alpha);
-        fast_vline(self, xm + y, ym - x, 2 * x + 1, color, alpha);
-        fast_vline(self, xm - x, ym - y, 2 * y + 1, color, alpha);
-        fast_vline(self, xm - y, ym - x, 2 * x + 1, color, alpha);
+
+        mp_float_t z = 1.0 / (3.0 * sum);
+        vsx = (int)(vsx * z);
+        vsy = (int)(vsy * z);
+    } else {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
     }
-    return mp_const_none;
+
+    mp_obj_t center[2] = {mp_obj_new_int(vsx), mp_obj_new_int(vsy)};
+    return mp_obj_new_tuple(2, center);
 }
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_center_obj, 2, 2, s3lcd_polygon_center);
 
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_fill_circle_obj, 4, 6, s3lcd_fill_circle);
+//
+// RotatePolygon: Rotate a polygon around a center point angle radians
+//
 
-///
-/// .rect(x, y, w, h {, color, alpha})
-/// Draw a rectangle.
-/// required parameters:
-/// -- x: x coordinate
-/// -- y: y coordinate
-/// -- w: width
-/// -- h: height
-/// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
-///
+static void RotatePolygon(Polygon *polygon, Point center, mp_float_t angle) {
+    if (polygon->length == 0) {
+        return;                                     /* reject null polygons */
 
-static mp_obj_t s3lcd_rect(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t x = mp_obj_get_int(args[1]);
-    mp_int_t y = mp_obj_get_int(args[2]);
-    mp_int_t w = mp_obj_get_int(args[3]);
-    mp_int_t h = mp_obj_get_int(args[4]);
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, color, WHITE)
-    OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, alpha, 255)
+    }
+    mp_float_t cosAngle = MICROPY_FLOAT_C_FUN(cos)(angle);
+    mp_float_t sinAngle = MICROPY_FLOAT_C_FUN(sin)(angle);
 
-    fast_hline(self, x, y, w, color, alpha);
-    fast_vline(self, x, y, h, color, alpha);
-    fast_hline(self, x, y + h - 1, w, color, alpha);
-    fast_vline(self, x + w - 1, y, h, color, alpha);
-    return mp_const_none;
+    for (int i = 0; i < polygon->length; i++) {
+        mp_float_t dx = (polygon->points[i].x - center.x);
+        mp_float_t dy = (polygon->points[i].y - center.y);
+
+        polygon->points[i].x = center.x + (int)0.5 + (dx * cosAngle - dy * sinAngle);
+        polygon->points[i].y = center.y + (int)0.5 + (dx * sinAngle + dy * cosAngle);
+    }
 }
 
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_rect_obj, 5, 7, s3lcd_rect);
+//
+// Fixed point sine and cosine. Angles are in 1/256 degree units and results
+// are scaled by 1 << 15. The quarter wave table holds the sine of each whole
+// degree from 0 to 90 and values between degrees are interpolated.
+//
 
-///
-/// .color565(r, g, b)
-/// Convert RGB888 to RGB565.
-/// required parameters:
-/// -- r: red
-/// -- g: green
-/// -- b: blue
-///
+#define FIXED_DEGREE 256
+#define FIXED_SHIFT 15
+
+static const uint16_t sin_table[91] = {
+        0,   572,  1144,  1715,  2286,  2856,  3425,  3993,  4560,  5126,
+     5690,  6252,  6813,  7371,  7927,  8481,  9032,  9580, 10126, 10668,
+    11207, 11743, 12275, 12803, 13328, 13848, 14365, 14876, 15384, 15886,
+    16384, 16877, 17364, 17847, 18324, 18795, 19261, 19720, 20174, 20622,
+    21063, 21498, 21926, 22348, 22763, 23170, 23571, 23965, 24351, 24730,
+    25102, 25466, 25822, 26170, 26510, 26842, 27166, 27482, 27789, 28088,
+    28378, 28660, 28932, 29197, 29452, 29698, 29935, 30163, 30382, 30592,
+    30792, 30983, 31164, 31336, 31499, 31651, 31795, 31928, 32052, 32166,
+    32270, 32365, 32449, 32524, 32588, 32643, 32688, 32723, 32748, 32763,
+    32768,
+};
 
-static mp_obj_t s3lcd_color565(mp_obj_t r, mp_obj_t g, mp_obj_t b) {
-    return MP_OBJ_NEW_SMALL_INT(color565(
-        (uint8_t)mp_obj_get_int(r),
-        (uint8_t)mp_obj_get_int(g),
-        (uint8_t)mp_obj_get_int(b)));
-}
-static MP_DEFINE_CONST_FUN_OBJ_3(s3lcd_color565_obj, s3lcd_color565);
+static int32_t fixed_sin(int32_t angle) {
+    angle %= 360 * FIXED_DEGREE;
+    if (angle < 0) {
+        angle += 360 * FIXED_DEGREE;
+    }
 
-static void map_bitarray_to_rgb565(uint8_t const *bitarray, uint16_t *buffer, int length, int width,
-    uint16_t color, uint16_t bg_color) {
-    int row_pos = 0;
-    for (int i = 0; i < length; i++) {
-        uint8_t byte = bitarray[i];
-        for (int bi = 7; bi >= 0; bi--) {
-            uint8_t b = byte & (1 << bi);
-            uint16_t cur_color = b ? color : bg_color;
-            *buffer++ = cur_color;
-            row_pos++;
-            if (row_pos >= width) {
-                row_pos = 0;
-                break;
-            }
-        }
+    bool negative = angle >= 180 * FIXED_DEGREE;
+    if (negative) {
+        angle -= 180 * FIXED_DEGREE;
+    }
+    if (angle > 90 * FIXED_DEGREE) {
+        angle = 180 * FIXED_DEGREE - angle;
     }
+
+    int idx = angle / FIXED_DEGREE;
+    int frac = angle % FIXED_DEGREE;
+    int32_t value = sin_table[idx];
+    if (frac) {
+        value += ((sin_table[idx + 1] - value) * frac + FIXED_DEGREE / 2) / FIXED_DEGREE;
+    }
+    return negative ? -value : value;
 }
 
-///
-/// .map_bitarray_to_rgb565(bitarray, buffer, width {, color, bg_color})
-/// Map a bitarray to a buffer of RGB565 pixels.
-/// required parameters:
-/// -- bitarray: bitarray
-/// -- buffer: buffer
-/// -- width: width
-/// optional parameters:
-/// -- color: color
-/// -- bg_color: background color
-///
+static inline int32_t fixed_cos(int32_t angle) {
+    return fixed_sin(angle + 90 * FIXED_DEGREE);
+}
 
-static mp_obj_t s3lcd_map_bitarray_to_rgb565(size_t n_args, const mp_obj_t *args) {
-    mp_buffer_info_t bitarray_info;
-    mp_buffer_info_t buffer_info;
+// radians to 1/256 degree units
+static int32_t fixed_angle(mp_float_t angle) {
+    angle = MICROPY_FLOAT_C_FUN(fmod)(angle, 2 * MP_PI);
+    return (int32_t)MICROPY_FLOAT_C_FUN(floor)(angle * (180 * FIXED_DEGREE / MP_PI) + (mp_float_t)0.5);
+}
 
-    mp_get_buffer_raise(args[1], &bitarray_info, MP_BUFFER_READ);
-    mp_get_buffer_raise(args[2], &buffer_info, MP_BUFFER_WRITE);
-    mp_int_t width = mp_obj_get_int(args[3]);
-    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
-    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, bg_color, BLACK)
+//
+// RotatePolygonFixed: Rotate packed 24.8 fixed point vertices around a center
+// point angle radians into points using the fixed point sine table. The
+// vertices stay in fixed point for the whole rotation and are converted to
+// points once, so the results can differ from RotatePolygon by a fraction of
+// a pixel.
+//
 
-    map_bitarray_to_rgb565(bitarray_info.buf, buffer_info.buf, bitarray_info.len, width, color, bg_color);
-    return mp_const_none;
+static void RotatePolygonFixed(const s3lcd_vertices_t *vertices, Point center, mp_float_t angle, Point *points) {
+    int32_t a = fixed_angle(angle);
+    int64_t cos_angle = fixed_cos(a);
+    int64_t sin_angle = fixed_sin(a);
+    int32_t cx = (int32_t)MICROPY_FLOAT_C_FUN(floor)(center.x * (1 << VERTEX_SHIFT) + (mp_float_t)0.5);
+    int32_t cy = (int32_t)MICROPY_FLOAT_C_FUN(floor)(center.y * (1 << VERTEX_SHIFT) + (mp_float_t)0.5);
+    const int32_t *xy = vertices->xy;
+
+    for (int i = 0; i < vertices->length; i++, xy += 2) {
+        int64_t dx = xy[0] - cx;
+        int64_t dy = xy[1] - cy;
+        int32_t x = cx + (int32_t)((dx * cos_angle - dy * sin_angle + (1 << (FIXED_SHIFT - 1))) >> FIXED_SHIFT);
+        int32_t y = cy + (int32_t)((dx * sin_angle + dy * cos_angle + (1 << (FIXED_SHIFT - 1))) >> FIXED_SHIFT);
+        points[i].x = (mp_float_t)x / (1 << VERTEX_SHIFT);
+        points[i].y = (mp_float_t)y / (1 << VERTEX_SHIFT);
+    }
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_map_bitarray_to_rgb565_obj, 3, 7, s3lcd_map_bitarray_to_rgb565);
 
 //
-// jpg routines
+// polygon_parse: Convert a list of (x, y) points, a list of contours that
+// are each a list of (x, y) points, or an array of x, y values to packed
+// 24.8 fixed point vertices. The vertices must be released with
+// vertices_free.
 //
 
-// User defined device identifier
-typedef struct {
-    mp_file_t *fp;                      // File pointer for input function
-    uint8_t *fbuf;                      // Pointer to the frame buffer for output function
-    uint16_t wfbuf;                     // Width of the frame buffer [pix]
-    uint16_t left;                      // jpg crop left column
-    uint16_t top;                       // jpg crop top row
-    uint16_t right;                     // jpg crop right column
-    uint16_t bottom;                    // jpg crop bottom row
+static int32_t vertex_fixed(mp_obj_t value) {
+    if (mp_obj_is_small_int(value)) {
+        mp_int_t v = MP_OBJ_SMALL_INT_VALUE(value);
+        if (v < -VERTEX_LIMIT || v > VERTEX_LIMIT) {
+            mp_raise_ValueError(MP_ERROR_TEXT("Polygon coordinate out of range"));
+        }
+        return (int32_t)v * (1 << VERTEX_SHIFT);
+    }
+
+    mp_float_t v = mp_obj_get_float(value);
+    if (!(v >= -VERTEX_LIMIT && v <= VERTEX_LIMIT)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("Polygon coordinate out of range"));
+    }
+    return (int32_t)MICROPY_FLOAT_C_FUN(floor)(v * (1 << VERTEX_SHIFT) + (mp_float_t)0.5);
+}
+
+static void polygon_parse(mp_obj_t polygon_obj, s3lcd_vertices_t *vertices) {
+    mp_buffer_info_t bufinfo;
+    if (!mp_obj_is_type(polygon_obj, &mp_type_list) && !mp_obj_is_type(polygon_obj, &mp_type_tuple) &&
+        mp_get_buffer(polygon_obj, &bufinfo, MP_BUFFER_READ)) {
+        size_t count = bufinfo.len / mp_binary_get_size('@', bufinfo.typecode, NULL) / 2;
+        if (count == 0) {
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+        }
+        int32_t *xy = m_new(int32_t, count * 2);
+        if (bufinfo.typecode == 'h') {
+            const int16_t *values = bufinfo.buf;
+            for (size_t idx = 0; idx < count * 2; idx++) {
+                xy[idx] = (int32_t)values[idx] * (1 << VERTEX_SHIFT);
+            }
+        } else {
+            for (size_t idx = 0; idx < count * 2; idx++) {
+                xy[idx] = vertex_fixed(mp_binary_get_val_array(bufinfo.typecode, bufinfo.buf, idx));
+            }
+        }
+        vertices->xy = xy;
+        vertices->ends = m_new(int, 1);
+        vertices->contours = 1;
+        vertices->length = count;
+        vertices->ends[0] = count;
+        return;
+    }
+
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(polygon_obj, &len, &items);
+    if (len == 0) {
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+    }
+
+    // a list of contours when the first item is not an (x, y) point
+    size_t contours = 1;
+    mp_obj_t *contour = &polygon_obj;
+    size_t item_len;
+    mp_obj_t *item;
+    mp_obj_get_array(items[0], &item_len, &item);
+    if (item_len > 0 && !mp_obj_is_int(item[0]) && !mp_obj_is_float(item[0])) {
+        contours = len;
+        contour = items;
+    }
+
+    size_t total = 0;
+    for (size_t c = 0; c < contours; c++) {
+        mp_obj_get_array(contour[c], &item_len, &item);
+        total += item_len;
+    }
+
+    // convert before storing so a bad point does not leave half built vertices
+    int32_t *xy = m_new(int32_t, total * 2);
+    int *ends = m_new(int, contours);
+    size_t length = 0;
+    for (size_t c = 0; c < contours; c++) {
+        mp_obj_get_array(contour[c], &len, &items);
+        for (size_t idx = 0; idx < len; idx++) {
+            mp_obj_get_array(items[idx], &item_len, &item);
+            if (item_len < 2) {
+                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            }
+            xy[length * 2] = vertex_fixed(item[0]);
+            xy[length * 2 + 1] = vertex_fixed(item[1]);
+            length++;
+        }
+        ends[c] = length;
+    }
 
-    s3lcd_obj_t *self;                  // display object
+    vertices->xy = xy;
+    vertices->ends = ends;
+    vertices->contours = contours;
+    vertices->length = length;
+}
 
-    uint8_t *data;                      // Pointer to the input data
-    uint32_t dataIdx;                   // Index of the input data
-    uint32_t dataLen;                   // Length of the input data
+static void polygon_free(Polygon *polygon) {
+    m_free(polygon->points);
+    m_free(polygon->ends);
+    polygon->points = NULL;
+    polygon->ends = NULL;
+    polygon->length = 0;
+    polygon->contours = 0;
+}
 
-} IODEV;
+static void polygon_bounds(Polygon *polygon, Point *min, Point *max) {
+    *min = *max = polygon->points[0];
+    for (int i = 1; i < polygon->length; i++) {
+        Point *p = &polygon->points[i];
+        min->x = (p->x < min->x) ? p->x : min->x;
+        min->y = (p->y < min->y) ? p->y : min->y;
+        max->x = (p->x > max->x) ? p->x : max->x;
+        max->y = (p->y > max->y) ? p->y : max->y;
+    }
+}
 
 //
-// buffer input function
+// polygon_transform: Convert vertices to points rotated angle radians about
+// center, with the fixed point sine table if fixed is true.
 //
 
-static unsigned int buffer_in_func(     // Returns number of bytes read (zero on error)
-    JDEC *jd,                           // Decompression object
-    uint8_t *buff,                      // Pointer to the read buffer (null to remove data)
-    unsigned int nbyte) {               // Number of bytes to read/remove
-    IODEV *dev = (IODEV *)jd->device;
+static void polygon_transform(const s3lcd_vertices_t *vertices, mp_float_t angle, Point center, bool fixed, Point *points) {
+    if (angle != 0 && fixed) {
+        RotatePolygonFixed(vertices, center, angle, points);
+        return;
+    }
 
-    if (dev->dataIdx + nbyte > dev->dataLen) {
-        nbyte = dev->dataLen - dev->dataIdx;
+    for (int i = 0; i < vertices->length; i++) {
+        points[i].x = (mp_float_t)vertices->xy[i * 2] / (1 << VERTEX_SHIFT);
+        points[i].y = (mp_float_t)vertices->xy[i * 2 + 1] / (1 << VERTEX_SHIFT);
+    }
+    if (angle != 0) {
+        Polygon polygon = {vertices->length, points, vertices->contours, vertices->ends};
+        RotatePolygon(&polygon, center, angle);
     }
+}
 
-    if (buff) {
-        memcpy(buff, (uint8_t *)(dev->data + dev->dataIdx), nbyte);
+//
+// polygon_rotate: Get the pose of a Polygon object rotated angle radians
+// about center, with the fixed point sine table if fixed is true. The poses
+// drawn last are cached, a pose that is not cached replaces the least
+// recently used one so alternating between two angles does not rotate the
+// polygon again.
+//
+
+static s3lcd_polygon_pose_t *polygon_rotate(s3lcd_polygon_obj_t *self, mp_float_t angle, Point center, bool fixed) {
+    s3lcd_polygon_pose_t *pose;
+    for (int i = 0; i < POLYGON_POSES; i++) {
+        pose = &self->poses[i];
+        if (pose->valid && pose->angle == angle &&
+            (angle == 0 || (center.x == pose->center.x && center.y == pose->center.y && fixed == pose->fixed))) {
+            self->recent = i;
+            return pose;
+        }
     }
 
-    dev->dataIdx += nbyte;
-    return nbyte;
+    self->recent = (self->recent + 1) % POLYGON_POSES;
+    pose = &self->poses[self->recent];
+    polygon_transform(&self->vertices, angle, center, fixed, pose->points);
+    Polygon polygon = {self->vertices.length, pose->points, self->vertices.contours, self->vertices.ends};
+    polygon_bounds(&polygon, &pose->min, &pose->max);
+    pose->angle = angle;
+    pose->center = center;
+    pose->fixed = fixed;
+    pose->valid = true;
+    return pose;
+}
+
+static void s3lcd_polygon_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    s3lcd_polygon_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<Polygon points=%d, contours=%d>", self->vertices.length, self->vertices.contours);
 }
 
+///
+/// s3lcd.Polygon(points)
+/// Parse a polygon once for the polygon, aa_polygon, fill_polygon and
+/// aa_fill_polygon methods. The vertices are stored in 24.8 fixed point and
+/// the last two rotations are kept so drawing the polygon again at either
+/// angle does not rotate it again.
+/// required parameters:
+/// -- points: a list of points [(x1, y1), (x2, y2), ...], a list of
+///    contours that are each a list of points, or an array of x, y values
+///
 
-//
-// file input function
-//
+static mp_obj_t s3lcd_polygon_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    mp_arg_check_num(n_args, n_kw, 1, 1, false);
 
-static unsigned int file_in_func(           // Returns number of bytes read (zero on error)
-    JDEC *jd,                               // Decompression object
-    uint8_t *buff,                          // Pointer to the read buffer (null to remove data)
-    unsigned int nbyte) {                   // Number of bytes to read/remove
-    IODEV *dev = (IODEV *)jd->device;       // Device identifier for the session (5th argument of jd_prepare function)
-    unsigned int nread;
+    s3lcd_polygon_obj_t *self = m_new_obj(s3lcd_polygon_obj_t);
+    self->base.type = &s3lcd_polygon_type;
+    polygon_parse(all_args[0], &self->vertices);
+    for (int i = 0; i < POLYGON_POSES; i++) {
+        self->poses[i].points = m_new(Point, self->vertices.length);
+        self->poses[i].valid = false;
+    }
+    self->recent = 0;
 
-    if (buff) {                             // Read data from input stream
-        nread = (unsigned int)mp_readinto(dev->fp, buff, nbyte);
-        return nread;
+    Point origin = {0, 0};
+    s3lcd_polygon_pose_t *pose = polygon_rotate(self, 0, origin, false);
+    self->min = pose->min;
+    self->max = pose->max;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+///
+/// .bounds({angle, cx, cy})
+/// returns:
+/// -- tuple of (min_x, min_y, max_x, max_y) of the polygon rotated angle
+///    radians about cx, cy
+///
+
+static mp_obj_t s3lcd_polygon_bounds(size_t n_args, const mp_obj_t *args) {
+    s3lcd_polygon_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    OPTIONAL_ARG(1, mp_float_t, mp_obj_get_float, angle, 0)
+    OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, cx, 0)
+    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, cy, 0)
+
+    Point *min = &self->min;
+    Point *max = &self->max;
+    if (angle != 0) {
+        Point center = {cx, cy};
+        s3lcd_polygon_pose_t *pose = polygon_rotate(self, angle, center, self->poses[self->recent].fixed);
+        min = &pose->min;
+        max = &pose->max;
     }
 
-    // Remove data from input stream if buff was NULL
-    mp_seek(dev->fp, nbyte, SEEK_CUR);
-    return 0;
+    mp_obj_t result[4] = {
+        mp_obj_new_float(min->x),
+        mp_obj_new_float(min->y),
+        mp_obj_new_float(max->x),
+        mp_obj_new_float(max->y),
+    };
+    return mp_obj_new_tuple(4, result);
 }
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_bounds_obj, 1, 4, s3lcd_polygon_bounds);
 
 //
-// jpg output function
+// polygon_pose: Get the points and bounds of a Polygon object rotated angle
+// radians about center the way it was last drawn.
 //
 
-static int jpg_out(                                         // 1:Ok, 0:Aborted
-    JDEC *jd,                                               // Decompression object
-    void *bitmap,                                           // Bitmap data to be output
-    JRECT *rect) {                                          // Rectangular region of output image
-    IODEV *dev = (IODEV *)jd->device;
-    uint16_t wd = dev->wfbuf;
-    uint16_t ws = rect->right - rect->left + 1;
-    uint16_t stride = wd - ws;
+static void polygon_pose(s3lcd_polygon_obj_t *self, mp_float_t angle, Point center, Polygon *polygon, Point *min, Point *max) {
+    s3lcd_polygon_pose_t *pose = polygon_rotate(self, angle, center, self->poses[self->recent].fixed);
+    polygon->length = self->vertices.length;
+    polygon->points = pose->points;
+    polygon->contours = self->vertices.contours;
+    polygon->ends = self->vertices.ends;
+    *min = pose->min;
+    *max = pose->max;
+}
 
-    // Copy the decompressed RGB rectangular to the frame buffer (assuming RGB565)
-    uint16_t *src = (uint16_t *) bitmap;
-    uint16_t *dst = (uint16_t *) dev->fbuf + ((rect->top + jd->y_offs) * dev->wfbuf + rect->left + jd->x_offs);
+//
+// point_in_polygon: Return true if x, y is inside the polygon using the
+// even-odd rule.
+//
 
-    for (int y = rect->top; y <= rect->bottom; y++) {
-        for (int x = rect->left; x <= rect->right; x++) {
-            if ( x+jd->x_offs < 0 || x+jd->x_offs >= dev->self->width || y+jd->y_offs < 0 || y+jd->y_offs >= dev->self->height) {
-                src++;
-                dst++;
-            }
-            else {
-                *dst++ = *src++;
+static bool point_in_polygon(Polygon *polygon, mp_float_t x, mp_float_t y) {
+    bool inside = false;
+    int start = 0;
+    for (int c = 0; c < polygon->contours; c++) {
+        int end = polygon->ends[c];
+        for (int i = start, j = end - 1; i < end; j = i++) {
+            Point *a = &polygon->points[i];
+            Point *b = &polygon->points[j];
+            if ((a->y > y) != (b->y > y) && x < a->x + (y - a->y) * (b->x - a->x) / (b->y - a->y)) {
+                inside = !inside;
             }
         }
-        dst += stride;
+        start = end;
     }
-    return 1;
+    return inside;
 }
 
-///
-/// .jpg(filename, x, y)
-/// Draw jpg from a file at x, y
-/// required parameters:
-/// -- filename: filename
-/// -- x: x
-/// -- y: y
+//
+// polygon_separated: Return true if an edge of a, offset by a_offset, is a
+// separating axis between the points of a and b offset by b_offset.
+//
 
-static mp_obj_t s3lcd_jpg(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    mp_int_t x = mp_obj_get_int(args[2]);
-    mp_int_t y = mp_obj_get_int(args[3]);
+static bool polygon_separated(Polygon *a, Point a_offset, Polygon *b, Point b_offset) {
+    int start = 0;
+    for (int c = 0; c < a->contours; c++) {
+        int end = a->ends[c];
+        for (int i = start, j = end - 1; i < end; j = i++) {
+            mp_float_t nx = a->points[j].y - a->points[i].y;
+            mp_float_t ny = a->points[i].x - a->points[j].x;
+            if (nx == 0 && ny == 0) {
+                continue;
+            }
 
-    JRESULT res;                                    // Result code of TJpgDec API
-    JDEC jdec;                                      // Decompression object
-    IODEV devid;                                    // User defined device identifier
-    self->work = (void *)m_malloc(3100);            // Pointer to the work area
-    static unsigned int (*input_func)(JDEC *, uint8_t *, unsigned int) = NULL;
+            mp_float_t a_min = INFINITY, a_max = -INFINITY;
+            for (int k = 0; k < a->length; k++) {
+                mp_float_t d = (a->points[k].x + a_offset.x) * nx + (a->points[k].y + a_offset.y) * ny;
+                a_min = (d < a_min) ? d : a_min;
+                a_max = (d > a_max) ? d : a_max;
+            }
 
-    if (mp_obj_is_type(args[1], &mp_type_bytes)) {
-        mp_buffer_info_t bufinfo;
-        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
-        devid.dataIdx = 0;
-        devid.data = bufinfo.buf;
-        devid.dataLen = bufinfo.len;
-        input_func = buffer_in_func;
-        self->fp = MP_OBJ_NULL;
-    } else {
-        const char *filename = mp_obj_str_get_str(args[1]);
-        self->fp = mp_open(filename, "rb");
-        devid.fp = self->fp;
-        input_func = file_in_func;
-        devid.data = MP_OBJ_NULL;
-        devid.dataLen = 0;
-    }
+            mp_float_t b_min = INFINITY, b_max = -INFINITY;
+            for (int k = 0; k < b->length; k++) {
+                mp_float_t d = (b->points[k].x + b_offset.x) * nx + (b->points[k].y + b_offset.y) * ny;
+                b_min = (d < b_min) ? d : b_min;
+                b_max = (d > b_max) ? d : b_max;
+            }
 
-    if (devid.fp || devid.data) {
-        jdec.x_offs = x;
-        jdec.y_offs = y;
-        // Prepare to decompress
-        res = jd_prepare(&jdec, input_func, self->work, 3100, &devid);
-        if (res == JDR_OK) {
-            // Initialize output device
-            devid.fbuf = (uint8_t *)self->frame_buffer;
-            devid.wfbuf = self->width;
-            devid.self = self;
-            res = jd_decomp(&jdec, jpg_out, 0);     // Start to decompress with 1/1 scaling
-            if (res != JDR_OK) {
-                mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg decompress failed: %d."), res);
+            if (a_max < b_min || b_max < a_min) {
+                return true;
             }
-        } else {
-            mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg prepare failed: %d."), res);
-        }
-        if (self->fp) {
-            mp_close(self->fp);
-            self->fp = MP_OBJ_NULL;
         }
+        start = end;
     }
-    m_free(self->work);     // Discard work area
-    return mp_const_none;
+    return false;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_jpg_obj, 4, 5, s3lcd_jpg);
-
-//
-// output function for jpg_decode
-//
 
-static int out_crop(                                // 1:Ok, 0:Aborted
-    JDEC *jd,                                       // Decompression object
-    void *bitmap,                                   // Bitmap data to be output
-    JRECT *rect) {                                  // Rectangular region of output image
-    IODEV *dev = (IODEV *)jd->device;
+static s3lcd_polygon_obj_t *polygon_obj_get(mp_obj_t polygon_obj) {
+    if (!mp_obj_is_type(polygon_obj, &s3lcd_polygon_type)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("Polygon required"));
+    }
+    return MP_OBJ_TO_PTR(polygon_obj);
+}
 
-    if (dev->left <= rect->right &&
-        dev->right >= rect->left &&
-        dev->top <= rect->bottom &&
-        dev->bottom >= rect->top) {
-        uint16_t left = MAX(dev->left, rect->left);
-        uint16_t top = MAX(dev->top, rect->top);
-        uint16_t right = MIN(dev->right, rect->right);
-        uint16_t bottom = MIN(dev->bottom, rect->bottom);
-        uint16_t dev_width = dev->right - dev->left + 1;
-        uint16_t rect_width = rect->right - rect->left + 1;
-        uint16_t width = (right - left + 1) * 2;
-        uint16_t row;
+///
+/// .contains(px, py {, x, y, angle, cx, cy})
+/// Test if a point is inside the polygon drawn at x, y rotated angle radians
+/// about cx, cy.
+/// required parameters:
+/// -- px: x coordinate of the point
+/// -- py: y coordinate of the point
+/// optional parameters:
+/// -- x: x coordinate of the polygon
+/// -- y: y coordinate of the polygon
+/// -- angle: angle the polygon is rotated
+/// -- cx: x coordinate of the center of rotation
+/// -- cy: y coordinate of the center of rotation
+/// returns:
+/// -- True if the point is inside the polygon
+///
 
-        for (row = top; row <= bottom; row++) {
-            memcpy(
-                (uint16_t *)dev->fbuf + ((row - dev->top) * dev_width) + left - dev->left,
-                (uint16_t *)bitmap + ((row - rect->top) * rect_width) + left - rect->left,
-                width);
-        }
+static mp_obj_t s3lcd_polygon_contains(size_t n_args, const mp_obj_t *args) {
+    s3lcd_polygon_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_float_t px = mp_obj_get_float(args[1]);
+    mp_float_t py = mp_obj_get_float(args[2]);
+    OPTIONAL_ARG(3, mp_float_t, mp_obj_get_float, x, 0)
+    OPTIONAL_ARG(4, mp_float_t, mp_obj_get_float, y, 0)
+    OPTIONAL_ARG(5, mp_float_t, mp_obj_get_float, angle, 0)
+    OPTIONAL_ARG(6, mp_int_t, mp_obj_get_int, cx, 0)
+    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, cy, 0)
+
+    Point center = {cx, cy};
+    Polygon polygon;
+    Point min, max;
+    polygon_pose(self, angle, center, &polygon, &min, &max);
+
+    px -= x;
+    py -= y;
+    if (px < min.x || px > max.x || py < min.y || py > max.y) {
+        return mp_const_false;
     }
-    return 1;   // Continue to decompress
+    return mp_obj_new_bool(point_in_polygon(&polygon, px, py));
 }
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_contains_obj, 3, 8, s3lcd_polygon_contains);
 
 ///
-/// .jpg_decode(filename {, x, y, width, height})
-/// Decode a jpg file and return it or a portion of it as a tuple containing a blittable buffer,
-/// the width and height of the buffer.
+/// .overlaps(other {, x, y, angle, other_x, other_y, other_angle})
+/// Test if the polygon overlaps another Polygon using the separating axis
+/// theorem. Both polygons are rotated about their own origin. The test is
+/// exact for convex polygons, concave polygons may overlap in their notches.
 /// required parameters:
-/// -- filename: filename
+/// -- other: the other Polygon
 /// optional parameters:
-/// -- x: x
-/// -- y: y
-/// -- width: width
-/// -- height: height
+/// -- x: x coordinate of the polygon
+/// -- y: y coordinate of the polygon
+/// -- angle: angle the polygon is rotated
+/// -- other_x: x coordinate of the other polygon
+/// -- other_y: y coordinate of the other polygon
+/// -- other_angle: angle the other polygon is rotated
+/// returns:
+/// -- True if the polygons overlap
 ///
 
-static mp_obj_t s3lcd_jpg_decode(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    const char *filename = NULL;
+static mp_obj_t s3lcd_polygon_overlaps(size_t n_args, const mp_obj_t *args) {
+    s3lcd_polygon_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    s3lcd_polygon_obj_t *other = polygon_obj_get(args[1]);
+    OPTIONAL_ARG(2, mp_float_t, mp_obj_get_float, x, 0)
+    OPTIONAL_ARG(3, mp_float_t, mp_obj_get_float, y, 0)
+    OPTIONAL_ARG(4, mp_float_t, mp_obj_get_float, angle, 0)
+    OPTIONAL_ARG(5, mp_float_t, mp_obj_get_float, other_x, 0)
+    OPTIONAL_ARG(6, mp_float_t, mp_obj_get_float, other_y, 0)
+    OPTIONAL_ARG(7, mp_float_t, mp_obj_get_float, other_angle, 0)
+
+    Point origin = {0, 0};
+    Polygon a, b;
+    Point a_min, a_max, b_min, b_max;
+    // the same object at two angles holds both in its two poses
+    polygon_pose(other, other_angle, origin, &b, &b_min, &b_max);
+    polygon_pose(self, angle, origin, &a, &a_min, &a_max);
+
+    bool overlap = false;
+    if (a_max.x + x >= b_min.x + other_x && b_max.x + other_x >= a_min.x + x &&
+        a_max.y + y >= b_min.y + other_y && b_max.y + other_y >= a_min.y + y) {
+        Point a_offset = {x, y};
+        Point b_offset = {other_x, other_y};
+        overlap = !polygon_separated(&a, a_offset, &b, b_offset) && !polygon_separated(&b, b_offset, &a, a_offset);
+    }
 
-    if (n_args == 2 || n_args == 6) {
-        OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, x, 0)
-        OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, y, 0)
-        OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, width, -1)
-        OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, height, -1)
+    return mp_obj_new_bool(overlap);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_overlaps_obj, 2, 8, s3lcd_polygon_overlaps);
 
-        self->work = (void *)m_malloc(3100);        // Pointer to the work area
-        JRESULT res;                                // Result code of TJpgDec API
-        JDEC jdec;                                  // Decompression object
-        IODEV devid;                                // User defined device identifier
-        size_t bufsize = 0;
-        static unsigned int (*input_func)(JDEC *, uint8_t *, unsigned int) = NULL;
+static const mp_rom_map_elem_t s3lcd_polygon_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_bounds), MP_ROM_PTR(&s3lcd_polygon_bounds_obj)},
+    {MP_ROM_QSTR(MP_QSTR_contains), MP_ROM_PTR(&s3lcd_polygon_contains_obj)},
+    {MP_ROM_QSTR(MP_QSTR_overlaps), MP_ROM_PTR(&s3lcd_polygon_overlaps_obj)},
+};
+static MP_DEFINE_CONST_DICT(s3lcd_polygon_locals_dict, s3lcd_polygon_locals_dict_table);
 
-        if (mp_obj_is_type(args[1], &mp_type_bytes)) {
-            mp_buffer_info_t bufinfo;
-            mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
-            devid.dataIdx = 0;
-            devid.data = bufinfo.buf;
-            devid.dataLen = bufinfo.len;
-            input_func = buffer_in_func;
-            self->fp = MP_OBJ_NULL;
-        } else {
-            filename = mp_obj_str_get_str(args[1]);
-            self->fp = mp_open(filename, "rb");
-            devid.fp = self->fp;
-            input_func = file_in_func;
-            devid.data = MP_OBJ_NULL;
-            devid.dataLen = 0;
+#if MICROPY_OBJ_TYPE_REPR == MICROPY_OBJ_TYPE_REPR_SLOT_INDEX
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    s3lcd_polygon_type,
+    MP_QSTR_Polygon,
+    MP_TYPE_FLAG_NONE,
+    print, s3lcd_polygon_print,
+    make_new, s3lcd_polygon_make_new,
+    locals_dict, &s3lcd_polygon_locals_dict);
+
+#else
+
+const mp_obj_type_t s3lcd_polygon_type = {
+    {&mp_type_type},
+    .name = MP_QSTR_Polygon,
+    .print = s3lcd_polygon_print,
+    .make_new = s3lcd_polygon_make_new,
+    .locals_dict = (mp_obj_dict_t *)&s3lcd_polygon_locals_dict,
+};
+
+#endif
+
+///
+/// s3lcd.hit_test(x, y, shapes)
+/// Find the first shape that contains a point.
+/// required parameters:
+/// -- x: x coordinate of the point
+/// -- y: y coordinate of the point
+/// -- shapes: a list of (polygon, x, y {, angle}) tuples of Polygon objects
+///    and where they are drawn, polygons are rotated about their origin
+/// returns:
+/// -- index of the first shape containing the point or -1
+///
+
+static mp_obj_t s3lcd_hit_test(mp_obj_t x_in, mp_obj_t y_in, mp_obj_t shapes_in) {
+    mp_float_t x = mp_obj_get_float(x_in);
+    mp_float_t y = mp_obj_get_float(y_in);
+    size_t shapes_len;
+    mp_obj_t *shapes;
+    mp_obj_get_array(shapes_in, &shapes_len, &shapes);
+
+    Point origin = {0, 0};
+    for (size_t idx = 0; idx < shapes_len; idx++) {
+        size_t shape_len;
+        mp_obj_t *shape;
+        mp_obj_get_array(shapes[idx], &shape_len, &shape);
+        if (shape_len < 3) {
+            mp_raise_ValueError(MP_ERROR_TEXT("shape must be (polygon, x, y {, angle})"));
         }
 
-        if (devid.fp || devid.data) {
-            // Prepare to decompress
-            res = jd_prepare(&jdec, input_func, self->work, 3100, &devid);
-            if (res == JDR_OK) {
-                if (n_args < 6) {
-                    x = 0;
-                    y = 0;
-                    width = jdec.width;
-                    height = jdec.height;
-                }
+        s3lcd_polygon_obj_t *obj = polygon_obj_get(shape[0]);
+        mp_float_t px = x - mp_obj_get_float(shape[1]);
+        mp_float_t py = y - mp_obj_get_float(shape[2]);
+        mp_float_t angle = (shape_len > 3) ? mp_obj_get_float(shape[3]) : 0;
+
+        Polygon polygon;
+        Point min, max;
+        polygon_pose(obj, angle, origin, &polygon, &min, &max);
+        if (px >= min.x && px <= max.x && py >= min.y && py <= max.y && point_in_polygon(&polygon, px, py)) {
+            return mp_obj_new_int(idx);
+        }
+    }
+    return mp_obj_new_int(-1);
+}
+static MP_DEFINE_CONST_FUN_OBJ_3(s3lcd_hit_test_obj, s3lcd_hit_test);
+
+//
+// polygon_get: Get the points of a polygon argument rotated angle radians
+// about center, using the fixed point sine table if the FIXED_ROTATE option
+// is set. Polygon objects return one of their cached poses, other polygons
+// are parsed and must be released with polygon_release.
+//
+
+static void polygon_get(s3lcd_obj_t *self, mp_obj_t polygon_obj, mp_float_t angle, Point center, Polygon *polygon) {
+    bool fixed = (self->options & OPTIONS_FIXED_ROTATE) != 0;
+    if (mp_obj_is_type(polygon_obj, &s3lcd_polygon_type)) {
+        s3lcd_polygon_obj_t *obj = MP_OBJ_TO_PTR(polygon_obj);
+        s3lcd_polygon_pose_t *pose = polygon_rotate(obj, angle, center, fixed);
+        polygon->length = obj->vertices.length;
+        polygon->points = pose->points;
+        polygon->contours = obj->vertices.contours;
+        polygon->ends = obj->vertices.ends;
+        return;
+    }
+
+    s3lcd_vertices_t vertices;
+    polygon_parse(polygon_obj, &vertices);
+    polygon->length = vertices.length;
+    polygon->points = m_new(Point, vertices.length);
+    polygon->contours = vertices.contours;
+    polygon->ends = vertices.ends;
+    polygon_transform(&vertices, angle, center, fixed, polygon->points);
+    m_free(vertices.xy);
+}
+
+//
+// polygon_hidden: Return true if polygon_obj is a Polygon object whose bounds,
+// in the pose polygon_get just returned, are off the frame buffer when drawn
+// at x, y. Lists are not checked.
+//
 
-                if (width == -1) {
-                    width = jdec.width;
-                }
+static bool polygon_hidden(s3lcd_obj_t *self, mp_obj_t polygon_obj, mp_int_t x, mp_int_t y) {
+    if (!mp_obj_is_type(polygon_obj, &s3lcd_polygon_type) || (self->options & OPTIONS_WRAP)) {
+        return false;
+    }
+    s3lcd_polygon_obj_t *obj = MP_OBJ_TO_PTR(polygon_obj);
+    Point *min = &obj->poses[obj->recent].min;
+    Point *max = &obj->poses[obj->recent].max;
+    return max->x + x < -1 || max->y + y < -1 || min->x + x > self->width || min->y + y > self->height;
+}
 
-                if (height == -1) {
-                    height = jdec.height;
-                }
+static void polygon_release(mp_obj_t polygon_obj, Polygon *polygon) {
+    if (!mp_obj_is_type(polygon_obj, &s3lcd_polygon_type)) {
+        polygon_free(polygon);
+    }
+}
 
-                // Initialize output device
-                devid.left = x;
-                devid.top = y;
-                devid.right = x + width - 1;
-                devid.bottom = y + height - 1;
+//
+// Active edge table polygon filler. Vertices are converted to 16.16 fixed
+// point once, each edge is entered in the bucket of the first row it crosses
+// and its x crossing is stepped incrementally from row to row while it is
+// active. A pixel is filled when its center is inside the polygon using the
+// even-odd or non-zero winding fill rule.
+//
 
-                bufsize = 2 * width * height;
-                self->work_buffer = m_malloc(bufsize);
-                if (self->work_buffer) {
-                    memset(self->work_buffer, 0, bufsize);
-                } else {
-                    mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("out of memory"));
-                }
+#define POLY_SHIFT 16
+#define POLY_ONE (1 << POLY_SHIFT)
+#define POLY_HALF (POLY_ONE >> 1)
+#define POLY_LIMIT 16383                        // largest coordinate in 16.16
+
+typedef struct _poly_edge_t {
+    int32_t x;          // x crossing at the center of the current row, 16.16
+    int32_t dxdy;       // change in x per row, 16.16
+    int16_t first;      // first row crossed by the edge
+    int16_t last;       // last row crossed by the edge
+    int8_t winding;     // 1 for downward edges, -1 for upward edges
+    int next;           // next edge that starts on the same row
+} poly_edge_t;
+
+static int32_t poly_fixed(mp_float_t v) {
+    if (v < -POLY_LIMIT) {
+        v = -POLY_LIMIT;
+    } else if (v > POLY_LIMIT) {
+        v = POLY_LIMIT;
+    }
+    return (int32_t)MICROPY_FLOAT_C_FUN(floor)(v * POLY_ONE + (mp_float_t)0.5);
+}
 
-                devid.fbuf = (uint8_t *)self->work_buffer;
-                devid.wfbuf = width;
-                devid.self = self;
-                res = jd_decomp(&jdec, out_crop, 0);
-                if (res != JDR_OK) {
-                    mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg decompress failed: %d."), res);
+// index of the first pixel whose center is at or after the 16.16 coordinate v
+static inline int poly_first(int32_t v) {
+    return (v - POLY_HALF + POLY_ONE - 1) >> POLY_SHIFT;
+}
+
+static void PolygonFill(s3lcd_obj_t *self, Polygon *polygon, Point location, uint16_t color, uint8_t alpha, int rule) {
+    bool wrap = (self->options & OPTIONS_WRAP) != 0;
+    int contours = (polygon->ends) ? polygon->contours : 1;
+    int top = INT_MAX;
+    int bottom = INT_MIN;
+    int count = 0;
+    int start = 0;
+
+    poly_edge_t *edges = m_new(poly_edge_t, polygon->length);
+
+    for (int c = 0; c < contours; c++) {
+        int end = (polygon->ends) ? polygon->ends[c] : polygon->length;
+        for (int i = start; i < end; i++) {
+            Point *p0 = &polygon->points[i];
+            Point *p1 = &polygon->points[(i + 1 < end) ? i + 1 : start];
+            int32_t x0 = poly_fixed(p0->x + location.x);
+            int32_t y0 = poly_fixed(p0->y + location.y);
+            int32_t x1 = poly_fixed(p1->x + location.x);
+            int32_t y1 = poly_fixed(p1->y + location.y);
+            int8_t winding = 1;
+
+            if (y0 > y1) {
+                int32_t swap = x0;
+                x0 = x1;
+                x1 = swap;
+                swap = y0;
+                y0 = y1;
+                y1 = swap;
+                winding = -1;
+            }
+
+            int first = poly_first(y0);
+            int last = poly_first(y1) - 1;
+            if (!wrap) {
+                if (first < 0) {
+                    first = 0;
                 }
-            } else {
-                mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("jpg prepare failed: %d."), res);
+                if (last >= self->height) {
+                    last = self->height - 1;
+                }
+            }
+            if (first > last) {
+                continue;                       // horizontal or between row centers
             }
 
-            if (self->fp) {
-                mp_close(self->fp);
-                self->fp = MP_OBJ_NULL;
+            // edges crossing more than one row are taller than a row, so the
+            // step is no larger than the width of the edge
+            poly_edge_t *edge = &edges[count++];
+            int32_t dx = x1 - x0;
+            int32_t dy = y1 - y0;
+            int64_t offset = ((int64_t)first << POLY_SHIFT) + POLY_HALF - y0;
+            edge->x = x0 + (int32_t)(dx * offset / dy);
+            edge->dxdy = (first < last) ? (int32_t)(((int64_t)dx << POLY_SHIFT) / dy) : 0;
+            edge->first = first;
+            edge->last = last;
+            edge->winding = winding;
+
+            if (first < top) {
+                top = first;
+            }
+            if (last > bottom) {
+                bottom = last;
             }
+        }
+        start = end;
+    }
 
-            m_free(self->work);                         // Discard work area
+    if (count == 0) {
+        m_free(edges);
+        return;
+    }
 
-            mp_obj_t result[3] = {
-                mp_obj_new_bytearray(bufsize, (mp_obj_t *)self->work_buffer),
-                mp_obj_new_int(width),
-                mp_obj_new_int(height)
-            };
+    // bucket the edges by the first row they cross
+    int *bucket = m_new(int, bottom - top + 1);
+    for (int row = top; row <= bottom; row++) {
+        bucket[row - top] = -1;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        edges[i].next = bucket[edges[i].first - top];
+        bucket[edges[i].first - top] = i;
+    }
 
-            return mp_obj_new_tuple(3, result);
-            self->work_buffer = NULL;
+    int *active = m_new(int, count);
+    int active_len = 0;
+
+    for (int row = top; row <= bottom; row++) {
+        for (int i = bucket[row - top]; i >= 0; i = edges[i].next) {
+            active[active_len++] = i;
         }
-    } else {
-        mp_raise_TypeError(MP_ERROR_TEXT("jpg_decode requires either 1 or 5 arguments"));
+
+        // insertion sort by x, the order changes little from row to row
+        for (int i = 1; i < active_len; i++) {
+            int e = active[i];
+            int32_t x = edges[e].x;
+            int j = i;
+            while (j > 0 && edges[active[j - 1]].x > x) {
+                active[j] = active[j - 1];
+                j--;
+            }
+            active[j] = e;
+        }
+
+        int inside = 0;
+        int32_t left = 0;
+        for (int i = 0; i < active_len; i++) {
+            poly_edge_t *edge = &edges[active[i]];
+            int was_inside = inside;
+            inside = (rule == FILL_NON_ZERO) ? inside + edge->winding : inside ^ 1;
+            if (was_inside == 0) {
+                left = edge->x;
+            } else if (inside == 0) {
+                int xs = poly_first(left);
+                int xe = poly_first(edge->x);
+                if (xe > xs) {
+                    fast_hline(self, xs, row, xe - xs, color, alpha);
+                }
+            }
+        }
+
+        // step the edges to the next row and drop the ones that end here
+        int kept = 0;
+        for (int i = 0; i < active_len; i++) {
+            poly_edge_t *edge = &edges[active[i]];
+            if (edge->last > row) {
+                edge->x += edge->dxdy;
+                active[kept++] = active[i];
+            }
+        }
+        active_len = kept;
     }
-    return mp_const_none;
+
+    m_free(active);
+    m_free(bucket);
+    m_free(edges);
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_jpg_decode_obj, 2, 6, s3lcd_jpg_decode);
 
 //
-// PNG Routines using the pngle library from https://github.com/kikuchan/pngle
-// licensed under the MIT License
+// Anti-aliased polygon filler. The area each edge covers is accumulated in
+// a band of coverage cells the width of the polygon's bounds, AA_FILL_ROWS
+// rows at a time. The coverage of each row only changes at cells an edge
+// touched, so runs of fully covered pixels are filled with the opaque fill
+// and only the pixels along the edges are blended.
 //
 
-typedef struct _PNG_USER_DATA {
-    s3lcd_obj_t *self;
-    int16_t top;                                   // draw png starting at this row
-    int16_t left;                                  // draw png starting at this column
-    int16_t fg_color;                              // override foreground color
-} PNG_USER_DATA;
+#define AA_FILL_ROWS 16
 
-void pngle_on_draw(pngle_t *pngle, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint8_t rgba[4]) {
-    PNG_USER_DATA *user_data = pngle_get_user_data(pngle);
-    s3lcd_obj_t *self = user_data->self;
+static inline uint8_t fill_coverage(float area, int rule) {
+    float c = fabsf(area);
+    if (rule == FILL_EVEN_ODD) {
+        c -= 2.0f * floorf(c * 0.5f);
+        if (c > 1.0f) {
+            c = 2.0f - c;
+        }
+    }
+    return (c >= 1.0f) ? 255 : (uint8_t)(c * 255.0f + 0.5f);
+}
 
-    if ( x+user_data->left >= self->width || y+user_data->top >= self->height) {
+static void PolygonFillAA(s3lcd_obj_t *self, Polygon *polygon, Point location, uint16_t color, uint8_t alpha, int rule) {
+    if (polygon->length == 0) {
         return;
     }
 
-    uint16_t color = (color565(rgba[0], rgba[1], rgba[2]));
-    _fill_rect(self, x + user_data->left, y + user_data->top, w, h, color, rgba[3]);
+    mp_float_t min_x = polygon->points[0].x, max_x = min_x;
+    mp_float_t min_y = polygon->points[0].y, max_y = min_y;
+    for (int i = 1; i < polygon->length; i++) {
+        Point *p = &polygon->points[i];
+        min_x = (p->x < min_x) ? p->x : min_x;
+        max_x = (p->x > max_x) ? p->x : max_x;
+        min_y = (p->y < min_y) ? p->y : min_y;
+        max_y = (p->y > max_y) ? p->y : max_y;
+    }
+
+    // bounds clipped to the frame buffer
+    mp_float_t left_f = MICROPY_FLOAT_C_FUN(floor)(min_x + location.x);
+    mp_float_t right_f = MICROPY_FLOAT_C_FUN(ceil)(max_x + location.x);
+    mp_float_t top_f = MICROPY_FLOAT_C_FUN(floor)(min_y + location.y);
+    mp_float_t bottom_f = MICROPY_FLOAT_C_FUN(ceil)(max_y + location.y);
+    int left = (left_f < 0) ? 0 : (left_f > self->width) ? self->width : (int)left_f;
+    int right = (right_f < 0) ? 0 : (right_f > self->width) ? self->width : (int)right_f;
+    int top = (top_f < 0) ? 0 : (top_f > self->height) ? self->height : (int)top_f;
+    int bottom = (bottom_f < 0) ? 0 : (bottom_f > self->height) ? self->height : (int)bottom_f;
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    s3lcd_raster_t r;
+    r.width = right - left;
+    r.height = (bottom - top < AA_FILL_ROWS) ? bottom - top : AA_FILL_ROWS;
+    r.stride = r.width + 2;
+    r.area = m_new(float, r.stride * r.height);
+
+    int contours = (polygon->ends) ? polygon->contours : 1;
+    for (int band = top; band < bottom; band += r.height) {
+        memset(r.area, 0, r.stride * r.height * sizeof(float));
+
+        float dx = (float)(location.x - left);
+        float dy = (float)(location.y - band);
+        int start = 0;
+        for (int c = 0; c < contours; c++) {
+            int end = (polygon->ends) ? polygon->ends[c] : polygon->length;
+            for (int i = start; i < end; i++) {
+                Point *p0 = &polygon->points[i];
+                Point *p1 = &polygon->points[(i + 1 < end) ? i + 1 : start];
+                s3lcd_raster_line(&r, p0->x + dx, p0->y + dy, p1->x + dx, p1->y + dy);
+            }
+            start = end;
+        }
+
+        int rows = (bottom - band < r.height) ? bottom - band : r.height;
+        for (int row = 0; row < rows; row++) {
+            const float *cell = r.area + row * r.stride;
+            float area = 0;
+            int x = 0;
+            while (x < r.width) {
+                area += cell[x];
+                int run = 1;
+                while (x + run < r.width && cell[x + run] == 0) {
+                    run++;
+                }
+
+                uint8_t coverage = fill_coverage(area, rule);
+                if (coverage == 255) {
+                    _fill_rect(self, left + x, band + row, run, 1, color, alpha);
+                } else if (coverage) {
+                    uint8_t a = coverage * alpha / 255;
+                    for (int i = 0; i < run; i++) {
+                        blend_pixel(self, left + x + i, band + row, color, a);
+                    }
+                }
+                x += run;
+            }
+        }
+    }
+
+    m_free(r.area);
 }
 
 ///
-/// .png(filename, x, y)
-/// Draw a PNG image on the display
+/// .polygon(polygon, x, y {, color, alpha, angle, cx, cy})
+/// Draw a polygon.
 /// required parameters:
-/// -- filename: the name of the file to load
-/// -- x: the x coordinate to draw the image
-/// -- y: the y coordinate to draw the image
+/// -- polygon: a list of points [(x1, y1), (x2, y2), ...]
+/// -- x: x coordinate
+/// -- y: y coordinate
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+/// -- angle: angle to rotate the polygon
+/// -- cx: x coordinate of the center of rotation
+/// -- cy: y coordinate of the center of rotation
 ///
 
-static mp_obj_t s3lcd_png(size_t n_args, const mp_obj_t *args) {
+static mp_obj_t s3lcd_polygon(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-
+    frame_buffer_required(self);
     mp_int_t x = mp_obj_get_int(args[2]);
     mp_int_t y = mp_obj_get_int(args[3]);
-
-    char *buf = (char *)self->dma_buffer; // Reuse the dma_buffer
-    int len, remain = 0;
-
-    PNG_USER_DATA user_data = {
-        self, y, x
-    };
-
-    // allocate new pngle_t and store in self to protect memory from gc
-    self->work = pngle_new(self);
-    pngle_t *pngle = (pngle_t *)self->work;
-    pngle_set_user_data(pngle, (void *)&user_data);
-    pngle_set_draw_callback(pngle, pngle_on_draw);
-
-    if (mp_obj_is_type(args[1], &mp_type_bytes)) {
-        mp_buffer_info_t bufinfo;
-        mp_get_buffer_raise(args[1], &bufinfo, MP_BUFFER_READ);
-        int fed = pngle_feed(pngle, bufinfo.buf, bufinfo.len);
-        if (fed < 0) {
-            mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("png decompress failed: %s"), pngle_error(pngle));
-        }
-    } else {
-        const char *filename = mp_obj_str_get_str(args[1]);
-        self->fp = mp_open(filename, "rb");
-        while ((len = mp_readinto(self->fp, buf + remain, self->dma_buffer_size - remain)) > 0) {
-            int fed = pngle_feed(pngle, buf, remain + len);
-            if (fed < 0) {
-                mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("png decompress failed: %s"), pngle_error(pngle));
-            }
-            remain = remain + len - fed;
-            if (remain > 0) {
-                memmove(buf, buf + fed, remain);
-            }
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+    OPTIONAL_ARG(6, mp_float_t, mp_obj_get_float, angle, 0)
+    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, cx, 0)
+    OPTIONAL_ARG(8, mp_int_t, mp_obj_get_int, cy, 0)
+
+    Point center = {cx, cy};
+    Polygon polygon;
+    polygon_get(self, args[1], angle, center, &polygon);
+
+    int contours = polygon_hidden(self, args[1], x, y) ? 0 : polygon.contours;
+    int start = 0;
+    for (int c = 0; c < contours; c++) {
+        Point *point = polygon.points;
+        for (int idx = start + 1; idx < polygon.ends[c]; idx++) {
+            line(
+                self,
+                (int)point[idx - 1].x + x,
+                (int)point[idx - 1].y + y,
+                (int)point[idx].x + x,
+                (int)point[idx].y + y,
+                color,
+                alpha);
         }
-        mp_close(self->fp);
+        start = polygon.ends[c];
     }
-    pngle_destroy(pngle);
-    self->work = NULL;
+
+    polygon_release(args[1], &polygon);
     return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_png_obj, 4, 4, s3lcd_png);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_obj, 4, 9, s3lcd_polygon);
 
 //
-//  png_write fileio callback functions
+// aa_fixed: round a polygon coordinate to 24.8 fixed-point pixels for aa_line.
 //
 
-int32_t pngWrite(PNGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
-    return mp_write((mp_file_t *) pFile->fHandle,  pBuf, iLen);
-}
-
-int32_t pngRead(PNGFILE *pFile, uint8_t *pBuf, int32_t iLen) {
-    return mp_readinto((mp_file_t *) pFile->fHandle, pBuf, iLen);
+static inline int32_t aa_fixed(mp_float_t v) {
+    return (int32_t)MICROPY_FLOAT_C_FUN(floor)(v * AA_ONE + (mp_float_t)0.5);
 }
 
-int32_t pngSeek(PNGFILE *pFile, int32_t iPosition) {
-    return mp_seek((mp_file_t *) pFile->fHandle, iPosition, SEEK_SET);
-}
+///
+/// .aa_polygon(polygon, x, y {, color, alpha, angle, cx, cy})
+/// Draw an anti-aliased polygon or polyline.
+/// required parameters:
+/// -- polygon: a list of points [(x1, y1), (x2, y2), ...]
+/// -- x: x coordinate
+/// -- y: y coordinate
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+/// -- angle: angle to rotate the polygon
+/// -- cx: x coordinate of the center of rotation
+/// -- cy: y coordinate of the center of rotation
+///
 
-void *pngOpen(const char *szFilename) {
-    return (void *)mp_open(szFilename, "w+b");
-}
+static mp_obj_t s3lcd_aa_polygon(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+    OPTIONAL_ARG(6, mp_float_t, mp_obj_get_float, angle, 0)
+    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, cx, 0)
+    OPTIONAL_ARG(8, mp_int_t, mp_obj_get_int, cy, 0)
+
+    Point center = {cx, cy};
+    Polygon polygon;
+    polygon_get(self, args[1], angle, center, &polygon);
+
+    // sides are drawn from the unrounded points, and shared points are drawn
+    // once, by the side that starts at them. The last point of a contour that
+    // closes on its first point was drawn by the first side.
+    int contours = polygon_hidden(self, args[1], x, y) ? 0 : polygon.contours;
+    int start = 0;
+    for (int c = 0; c < contours; c++) {
+        Point *point = polygon.points;
+        int end = polygon.ends[c];
+        int32_t x0 = aa_fixed(point[start].x + x);
+        int32_t y0 = aa_fixed(point[start].y + y);
+        int32_t first_x = x0, first_y = y0;
+        for (int idx = start + 1; idx < end; idx++) {
+            int32_t x1 = aa_fixed(point[idx].x + x);
+            int32_t y1 = aa_fixed(point[idx].y + y);
+            bool closed = x1 == first_x && y1 == first_y;
+            aa_line(self, x0, y0, x1, y1, color, alpha, idx == end - 1 && !closed);
+            x0 = x1;
+            y0 = y1;
+        }
+        start = end;
+    }
 
-void pngClose(PNGFILE *pFile) {
-    mp_close((mp_file_t *) pFile->fHandle);
+    polygon_release(args[1], &polygon);
+    return mp_const_none;
 }
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_aa_polygon_obj, 4, 9, s3lcd_aa_polygon);
 
 //
-// .png_write(file_name{ x, y, width, height})
+//  filled polygon
 //
-// save the framebuffer to a png file using PNGenc from
-// https://github.com/bitbank2/PNGenc
+
 //
-//  required parameters:
-//  -- filename: the name of the file to save
-//  optional parameters:
-//  -- x: the x coordinate to start saving
-//  -- y: the y coordinate to start saving
-//  -- width: the width of the area to save
-//  -- height: the height of the area to save
-//  returns:
-//  -- file size in bytes
+// fill_polygon: fill the polygon given by the fill_polygon arguments,
+// anti-aliased if aa is true.
 //
 
-static mp_obj_t s3lcd_png_write(size_t n_args, const mp_obj_t *args) {
+static mp_obj_t fill_polygon(size_t n_args, const mp_obj_t *args, bool aa) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
-    const char *filename = mp_obj_str_get_str(args[1]);
-    int data_size = 0;
-    int work_buffer_size = self->width * 3 * 2;
-    int rc;
-
-    if (n_args == 2 || n_args == 6) {
-        OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, x, 0)
-        OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, y, 0)
-        OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, width, self->width)
-        OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, height, self->height)
-
-        if (x >= 0 && x + width <= self->width &&
-            y >= 0 && y + height <= self->height) {
-
-            PNGIMAGE *pPNG = (PNGIMAGE *) m_malloc(sizeof(PNGIMAGE));
-            if (pPNG == NULL) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("memory allocation failed"));
-            }
-            self->work = pPNG;
+    frame_buffer_required(self);
+    mp_int_t x = mp_obj_get_int(args[2]);
+    mp_int_t y = mp_obj_get_int(args[3]);
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+    OPTIONAL_ARG(6, mp_float_t, mp_obj_get_float, angle, 0)
+    OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, cx, 0)
+    OPTIONAL_ARG(8, mp_int_t, mp_obj_get_int, cy, 0)
+    OPTIONAL_ARG(9, mp_int_t, mp_obj_get_int, rule, FILL_EVEN_ODD)
 
-            self->work_buffer = (uint16_t *) m_malloc(work_buffer_size);
-            if (self->work_buffer == NULL) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("memory allocation failed"));
-            }
+    if (rule != FILL_EVEN_ODD && rule != FILL_NON_ZERO) {
+        mp_raise_ValueError(MP_ERROR_TEXT("rule must be EVEN_ODD or NON_ZERO"));
+    }
 
-            rc = PNG_openFile(pPNG, filename, pngOpen, pngClose, pngRead, pngWrite, pngSeek);
-            if (rc != PNG_SUCCESS) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Error opening output file"));
-            }
+    Point center = {cx, cy};
+    Polygon polygon;
+    polygon_get(self, args[1], angle, center, &polygon);
 
-            rc = PNG_encodeBegin(pPNG, width, height, PNG_PIXEL_TRUECOLOR, 24, NULL, 9);
-            if (rc == PNG_SUCCESS) {
-                uint16_t *p = self->frame_buffer + x + self->width * y;
-                for (int row = y; row <= y+height && rc == PNG_SUCCESS; row++) {
-                    rc = PNG_addRGB565Line(pPNG, p, self->work_buffer, row-y);
-                    p += self->width;
-                }
-                data_size = PNG_close(pPNG);
-            }
-            m_free(pPNG);
-            self->work = NULL;
-            m_free(self->work_buffer);
-            self->work_buffer = NULL;
+    Point location = {x, y};
+    if (!polygon_hidden(self, args[1], x, y)) {
+        if (aa) {
+            PolygonFillAA(self, &polygon, location, color, alpha, rule);
+        } else {
+            PolygonFill(self, &polygon, location, color, alpha, rule);
         }
-    } else {
-        mp_raise_TypeError(MP_ERROR_TEXT("jpg_write requires either 1 or 5 arguments"));
     }
 
-    return mp_obj_new_int(data_size);
+    polygon_release(args[1], &polygon);
+    return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_png_write_obj, 2, 6, s3lcd_png_write);
 
 ///
-/// .polygon_center(polygon)
-/// Return the center of a polygon as an (x, y) tuple
+/// .fill_polygon(polygon, x, y {, color, alpha, angle, cx, cy, rule})
+/// Draw a filled polygon.
 /// required parameters:
-/// -- polygon: a list of (x, y) tuples
+/// -- polygon: a list of points [(x1, y1), (x2, y2), ...] or a list of
+///    contours that are each a list of points
+/// -- x: x coordinate
+/// -- y: y coordinate
+/// optional parameters:
+/// -- color: color
+/// -- alpha: alpha
+/// -- angle: angle to rotate the polygon
+/// -- cx: x coordinate of the center of rotation
+/// -- cy: y coordinate of the center of rotation
+/// -- rule: EVEN_ODD (default) or NON_ZERO fill rule
 ///
 
-static mp_obj_t s3lcd_polygon_center(size_t n_args, const mp_obj_t *args) {
-    size_t poly_len;
-    mp_obj_t *polygon;
-    mp_obj_get_array(args[1], &poly_len, &polygon);
+static mp_obj_t s3lcd_fill_polygon(size_t n_args, const mp_obj_t *args) {
+    return fill_polygon(n_args, args, false);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_fill_polygon_obj, 4, 10, s3lcd_fill_polygon);
 
-    mp_float_t sum = 0.0;
-    int vsx = 0;
-    int vsy = 0;
+///
+/// .aa_fill_polygon(polygon, x, y {, color, alpha, angle, cx, cy, rule})
+/// Draw an anti-aliased filled polygon, the parameters are the same as
+/// fill_polygon. Points may have fractional coordinates.
+///
 
-    if (poly_len > 0) {
-        for (int idx = 0; idx < poly_len; idx++) {
-            size_t point_from_poly_len;
-            mp_obj_t *point_from_poly;
-            mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
-            if (point_from_poly_len < 2) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-            }
+static mp_obj_t s3lcd_aa_fill_polygon(size_t n_args, const mp_obj_t *args) {
+    return fill_polygon(n_args, args, true);
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_aa_fill_polygon_obj, 4, 10, s3lcd_aa_fill_polygon);
 
-            mp_int_t v1x = mp_obj_get_int(point_from_poly[0]);
-            mp_int_t v1y = mp_obj_get_int(point_from_poly[1]);
 
-            mp_obj_get_array(polygon[(idx + 1) % poly_len], &point_from_poly_len, &point_from_poly);
-            if (point_from_poly_len < 2) {
-                mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-            }
+//
+// A DisplayList records draw calls as an opcode followed by the int16
+// arguments of the call, so a screen drawn the same way every frame can be
+// replayed from C with only the changed arguments patched. Buffers and
+// Labels are kept in the objects list and referenced by their index.
+// Text, bitmaps and polygons are recorded as calls, their arguments are kept
+// in a list in the objects list and the ESPLCD method is called with them
+// when the display list is replayed.
+//
 
-            mp_int_t v2x = mp_obj_get_int(point_from_poly[0]);
-            mp_int_t v2y = mp_obj_get_int(point_from_poly[1]);
+#define DL_FILL         0
+#define DL_PIXEL        1
+#define DL_LINE         2
+#define DL_AA_LINE      3
+#define DL_HLINE        4
+#define DL_VLINE        5
+#define DL_RECT         6
+#define DL_FILL_RECT    7
+#define DL_CIRCLE       8
+#define DL_FILL_CIRCLE  9
+#define DL_AA_CIRCLE    10
+#define DL_BLIT_BUFFER  11
+#define DL_BLIT_LABEL   12
+#define DL_TEXT         13
+#define DL_WRITE        14
+#define DL_DRAW         15
+#define DL_BITMAP       16
+#define DL_POLYGON      17
+#define DL_AA_POLYGON   18
+#define DL_FILL_POLYGON 19
+#define DL_AA_FILL_POLYGON 20
+
+#define DL_MAX_ARGS     6
+#define DL_CALL_ARGS    24      // positional arguments and keyword pairs of a call
+
+typedef struct _dl_op_t {
+    uint8_t args;           // arguments stored after the opcode
+    uint8_t y_args;         // bit mask of the arguments that are y coordinates
+    uint8_t color_args;     // bit mask of the arguments that are colors
+    uint16_t color;         // default color, the last argument defaults to 255
+    uint8_t y_arg;          // call ops: position of the y argument of the method
+    const void *method;     // call ops: ESPLCD method called when replayed
+} dl_op_t;
+
+static const dl_op_t dl_ops[] = {
+    [DL_FILL] = {2, 0x00, 0x01, BLACK},
+    [DL_PIXEL] = {4, 0x02, 0x04, WHITE},
+    [DL_LINE] = {6, 0x0a, 0x10, WHITE},
+    [DL_AA_LINE] = {6, 0x0a, 0x10, WHITE},
+    [DL_HLINE] = {5, 0x02, 0x08, WHITE},
+    [DL_VLINE] = {5, 0x02, 0x08, WHITE},
+    [DL_RECT] = {6, 0x02, 0x10, WHITE},
+    [DL_FILL_RECT] = {6, 0x02, 0x10, WHITE},
+    [DL_CIRCLE] = {5, 0x02, 0x08, WHITE},
+    [DL_FILL_CIRCLE] = {5, 0x02, 0x08, WHITE},
+    [DL_AA_CIRCLE] = {5, 0x02, 0x08, WHITE},
+    [DL_BLIT_BUFFER] = {6, 0x04, 0x00, 0},
+    [DL_BLIT_LABEL] = {3, 0x04, 0x00, 0},
+    [DL_TEXT] = {2, 0x00, 0x00, 0, 3, &s3lcd_text_obj},
+    [DL_WRITE] = {2, 0x00, 0x00, 0, 3, &s3lcd_write_obj},
+    [DL_DRAW] = {2, 0x00, 0x00, 0, 3, &s3lcd_draw_obj},
+    [DL_BITMAP] = {2, 0x00, 0x00, 0, 2, &s3lcd_bitmap_obj},
+    [DL_POLYGON] = {2, 0x00, 0x00, 0, 2, &s3lcd_polygon_obj},
+    [DL_AA_POLYGON] = {2, 0x00, 0x00, 0, 2, &s3lcd_aa_polygon_obj},
+    [DL_FILL_POLYGON] = {2, 0x00, 0x00, 0, 2, &s3lcd_fill_polygon_obj},
+    [DL_AA_FILL_POLYGON] = {2, 0x00, 0x00, 0, 2, &s3lcd_aa_fill_polygon_obj},
+};
 
-            mp_float_t cross = v1x * v2y - v1y * v2x;
-            sum += cross;
-            vsx += (int)((v1x + v2x) * cross);
-            vsy += (int)((v1y + v2y) * cross);
-        }
+//
+// display_list_arg: convert argument arg of a command to the int16 it is
+// stored in. Colors may be given as unsigned 16 bit values, every other
+// argument must fit in an int16.
+//
 
-        mp_float_t z = 1.0 / (3.0 * sum);
-        vsx = (int)(vsx * z);
-        vsy = (int)(vsy * z);
-    } else {
-        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+static int16_t display_list_arg(int op, int arg, mp_obj_t value) {
+    mp_int_t v = mp_obj_get_int(value);
+    mp_int_t max = (dl_ops[op].color_args & (1 << arg)) ? UINT16_MAX : INT16_MAX;
+    if (v < INT16_MIN || v > max) {
+        mp_raise_ValueError(MP_ERROR_TEXT("DisplayList argument out of range"));
     }
-
-    mp_obj_t center[2] = {mp_obj_new_int(vsx), mp_obj_new_int(vsy)};
-    return mp_obj_new_tuple(2, center);
+    return (int16_t)v;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_center_obj, 2, 2, s3lcd_polygon_center);
 
 //
-// RotatePolygon: Rotate a polygon around a center point angle radians
+// display_list_object: check the object drawn by a blit command.
 //
 
-static void RotatePolygon(Polygon *polygon, Point center, mp_float_t angle) {
-    if (polygon->length == 0) {
-        return;                                     /* reject null polygons */
+static void display_list_object(int op, mp_obj_t obj) {
+    if (op == DL_BLIT_LABEL) {
+        if (!mp_obj_is_type(obj, &s3lcd_label_type)) {
+            mp_raise_TypeError(MP_ERROR_TEXT("blit_label requires a Label"));
+        }
+    } else {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(obj, &bufinfo, MP_BUFFER_READ);
+    }
+}
+
+//
+// display_list_record: append a command with the arguments of a draw call
+// and return its index.
+//
 
+static int16_t *display_list_reserve(s3lcd_display_list_obj_t *self, int op) {
+    if (self->len + 1 + dl_ops[op].args > self->size) {
+        size_t size = (self->size) ? self->size * 2 : 64;
+        self->commands = m_renew(int16_t, self->commands, self->size, size);
+        self->size = size;
+    }
+    if (self->count == self->starts_size) {
+        size_t size = (self->starts_size) ? self->starts_size * 2 : 16;
+        self->starts = m_renew(uint32_t, self->starts, self->starts_size, size);
+        self->starts_size = size;
     }
-    mp_float_t cosAngle = MICROPY_FLOAT_C_FUN(cos)(angle);
-    mp_float_t sinAngle = MICROPY_FLOAT_C_FUN(sin)(angle);
 
-    for (int i = 0; i < polygon->length; i++) {
-        mp_float_t dx = (polygon->points[i].x - center.x);
-        mp_float_t dy = (polygon->points[i].y - center.y);
+    int16_t *cmd = self->commands + self->len;
+    cmd[0] = op;
+    return cmd;
+}
 
-        polygon->points[i].x = center.x + (int)0.5 + (dx * cosAngle - dy * sinAngle);
-        polygon->points[i].y = center.y + (int)0.5 + (dx * sinAngle + dy * cosAngle);
+static mp_obj_t display_list_commit(s3lcd_display_list_obj_t *self, int op) {
+    self->starts[self->count] = self->len;
+    self->len += 1 + dl_ops[op].args;
+    return mp_obj_new_int(self->count++);
+}
+
+static mp_obj_t display_list_record(size_t n_args, const mp_obj_t *args, int op) {
+    s3lcd_display_list_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    const dl_op_t *info = &dl_ops[op];
+    bool blit = (op == DL_BLIT_BUFFER || op == DL_BLIT_LABEL);
+
+    int16_t *cmd = display_list_reserve(self, op);
+    for (size_t i = blit ? 1 : 0; i < info->args; i++) {
+        if (i + 1 < n_args) {
+            cmd[i + 1] = display_list_arg(op, i, args[i + 1]);
+        } else {
+            cmd[i + 1] = (i == info->args - 1) ? 255 : info->color;
+        }
     }
+    if (blit) {
+        display_list_object(op, args[1]);
+        size_t len;
+        mp_obj_t *objects;
+        mp_obj_list_get(self->objects, &len, &objects);
+        cmd[1] = len;
+        mp_obj_list_append(self->objects, args[1]);
+    }
+    return display_list_commit(self, op);
 }
 
 //
-// public-domain code by Darel Rex Finley, 2007
-// https://alienryderflex.com/polygon_fill/
+// display_list_record_call: append a call of an ESPLCD method, keeping its
+// positional arguments followed by its keyword and value pairs in a list.
+// The command holds the index of the list and the number of keywords.
 //
 
-#define MAX_POLY_CORNERS 32
-static void PolygonFill(s3lcd_obj_t *self, Polygon *polygon, Point location, uint16_t color, uint8_t alpha) {
-    int nodes, nodeX[MAX_POLY_CORNERS], pixelY, i, j, swap;
+static mp_obj_t display_list_record_call(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args, int op) {
+    s3lcd_display_list_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    if (n_args - 1 + 2 * kw_args->used > DL_CALL_ARGS) {
+        mp_raise_TypeError(MP_ERROR_TEXT("too many arguments"));
+    }
 
-    int minX = INT_MAX;
-    int maxX = INT_MIN;
-    int minY = INT_MAX;
-    int maxY = INT_MIN;
+    // x and y are always positional, y is moved when drawn in strips
+    int y = dl_ops[op].y_arg + 1;
+    mp_obj_get_int(args[y - 1]);
+    mp_obj_get_int(args[y]);
 
-    for (i = 0; i < polygon->length; i++) {
-        if (polygon->points[i].x < minX) {
-            minX = (int)polygon->points[i].x;
+    mp_obj_t call = mp_obj_new_list(n_args - 1, (mp_obj_t *)args + 1);
+    for (size_t i = 0; i < kw_args->alloc; i++) {
+        if (mp_map_slot_is_filled(kw_args, i)) {
+            mp_obj_list_append(call, kw_args->table[i].key);
+            mp_obj_list_append(call, kw_args->table[i].value);
         }
+    }
 
-        if (polygon->points[i].x > maxX) {
-            maxX = (int)polygon->points[i].x;
-        }
+    int16_t *cmd = display_list_reserve(self, op);
+    size_t len;
+    mp_obj_t *objects;
+    mp_obj_list_get(self->objects, &len, &objects);
+    cmd[1] = len;
+    cmd[2] = kw_args->used;
+    mp_obj_list_append(self->objects, call);
+    return display_list_commit(self, op);
+}
 
-        if (polygon->points[i].y < minY) {
-            minY = (int)polygon->points[i].y;
-        }
+//
+// display_list_call: call the ESPLCD method of a recorded call with its y
+// argument moved up dy rows.
+//
 
-        if (polygon->points[i].y > maxY) {
-            maxY = (int)polygon->points[i].y;
-        }
+static void display_list_call(s3lcd_obj_t *self, int op, mp_obj_t call, size_t n_kw, int dy) {
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_list_get(call, &len, &items);
+    size_t n_pos = len - 2 * n_kw;
+
+    mp_obj_t args[1 + DL_CALL_ARGS];
+    args[0] = MP_OBJ_FROM_PTR(self);
+    memcpy(args + 1, items, len * sizeof(mp_obj_t));
+    if (dy) {
+        int y = dl_ops[op].y_arg;
+        args[y + 1] = mp_obj_new_int(mp_obj_get_int(items[y]) - dy);
     }
+    mp_call_function_n_kw(MP_OBJ_FROM_PTR(dl_ops[op].method), n_pos + 1, n_kw, args);
+}
 
-    // Loop through the rows
-    for (pixelY = minY; pixelY < maxY; pixelY++) {
-        // Build a list of nodes.
-        nodes = 0;
-        j = polygon->length - 1;
-        for (i = 0; i < polygon->length; i++) {
-            if ((polygon->points[i].y < pixelY && polygon->points[j].y >= pixelY) ||
-                (polygon->points[j].y < pixelY && polygon->points[i].y >= pixelY)) {
-                if (nodes < MAX_POLY_CORNERS) {
-                    nodeX[nodes++] = (int)(polygon->points[i].x +
-                        (pixelY - polygon->points[i].y) /
-                        (polygon->points[j].y - polygon->points[i].y) *
-                        (polygon->points[j].x - polygon->points[i].x));
-                } else {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon too complex increase MAX_POLY_CORNERS."));
-                }
-            }
-            j = i;
-        }
+//
+// display_list_bounds: get the area a command draws in, returns false if
+// the command draws the whole frame buffer.
+//
 
-        // Sort the nodes, via a simple “Bubble” sort.
-        i = 0;
-        while (i < nodes - 1) {
-            if (nodeX[i] > nodeX[i + 1]) {
-                swap = nodeX[i];
-                nodeX[i] = nodeX[i + 1];
-                nodeX[i + 1] = swap;
-                if (i) {
-                    i--;
-                }
-            } else {
-                i++;
-            }
+static bool display_list_bounds(int op, const int *a, mp_obj_t *objects, int *x0, int *y0, int *x1, int *y1) {
+    switch (op) {
+        case DL_PIXEL:
+            *x0 = a[0];
+            *y0 = a[1];
+            *x1 = a[0] + 1;
+            *y1 = a[1] + 1;
+            break;
+
+        case DL_LINE:
+        case DL_AA_LINE:
+            *x0 = MIN(a[0], a[2]);
+            *y0 = MIN(a[1], a[3]);
+            *x1 = MAX(a[0], a[2]) + 2;
+            *y1 = MAX(a[1], a[3]) + 2;
+            break;
+
+        case DL_HLINE:
+            *x0 = MIN(a[0], a[0] + a[2]);
+            *y0 = a[1];
+            *x1 = MAX(a[0], a[0] + a[2]);
+            *y1 = a[1] + 1;
+            break;
+
+        case DL_VLINE:
+            *x0 = a[0];
+            *y0 = MIN(a[1], a[1] + a[2]);
+            *x1 = a[0] + 1;
+            *y1 = MAX(a[1], a[1] + a[2]);
+            break;
+
+        case DL_RECT:
+        case DL_FILL_RECT:
+            *x0 = a[0];
+            *y0 = a[1];
+            *x1 = a[0] + a[2];
+            *y1 = a[1] + a[3];
+            break;
+
+        case DL_CIRCLE:
+        case DL_FILL_CIRCLE:
+        case DL_AA_CIRCLE:
+            *x0 = a[0] - a[2] - 1;
+            *y0 = a[1] - a[2] - 1;
+            *x1 = a[0] + a[2] + 2;
+            *y1 = a[1] + a[2] + 2;
+            break;
+
+        case DL_BLIT_BUFFER:
+            *x0 = a[1];
+            *y0 = a[2];
+            *x1 = a[1] + a[3];
+            *y1 = a[2] + a[4];
+            break;
+
+        case DL_BLIT_LABEL: {
+            s3lcd_label_obj_t *label = MP_OBJ_TO_PTR(objects[a[0]]);
+            *x0 = a[1];
+            *y0 = a[2];
+            *x1 = a[1] + label->width;
+            *y1 = a[2] + label->height;
+            break;
         }
 
-        // Fill the pixels between node pairs.
-        for (i = 0; i < nodes; i += 2) {
-            if (nodeX[i] >= maxX) {
-                break;
-            }
+        default:
+            return false;
+    }
+    return true;
+}
 
-            if (nodeX[i + 1] > minX) {
-                if (nodeX[i] < minX) {
-                    nodeX[i] = minX;
-                }
+//
+// display_list_replay: run the commands of a display list moved up dy rows,
+// skipping those that draw entirely outside of clip_x0, clip_y0 to clip_x1,
+// clip_y1.
+//
 
-                if (nodeX[i + 1] > maxX) {
-                    nodeX[i + 1] = maxX;
-                }
+static void display_list_replay(s3lcd_obj_t *self, s3lcd_display_list_obj_t *dl, int clip_x0, int clip_y0, int clip_x1, int clip_y1, int dy) {
+    size_t objects_len;
+    mp_obj_t *objects;
+    mp_obj_list_get(dl->objects, &objects_len, &objects);
+
+    // wrapped drawing can land anywhere, so nothing is culled
+    bool cull = (self->options & OPTIONS_WRAP) == 0;
+
+    const int16_t *cmd = dl->commands;
+    const int16_t *end = dl->commands + dl->len;
+    while (cmd < end) {
+        int op = *cmd++;
+        if (dl_ops[op].method) {
+            // calls are not culled, the methods clip what they draw
+            display_list_call(self, op, objects[cmd[0]], cmd[1], dy);
+            cmd += dl_ops[op].args;
+            continue;
+        }
 
-                fast_hline(self, (int)location.x + nodeX[i], (int)location.y + pixelY, nodeX[i + 1] - nodeX[i] + 1, color, alpha);
+        // moved coordinates can leave the int16 range, they are kept in
+        // int so lines are clipped rather than bent
+        int a[DL_MAX_ARGS];
+        for (int i = 0; i < dl_ops[op].args; i++) {
+            a[i] = *cmd++;
+            if (dl_ops[op].y_args & (1 << i)) {
+                a[i] -= dy;
             }
         }
-    }
-}
-
-///
-/// .polygon(polygon, x, y {, color, alpha, angle, cx, cy})
-/// Draw a polygon.
-/// required parameters:
-/// -- polygon: a list of points [(x1, y1), (x2, y2), ...]
-/// -- x: x coordinate
-/// -- y: y coordinate
-/// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
-/// -- angle: angle to rotate the polygon
-/// -- cx: x coordinate of the center of rotation
-/// -- cy: y coordinate of the center of rotation
-///
 
-static mp_obj_t s3lcd_polygon(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+        int x0, y0, x1, y1;
+        if (cull && display_list_bounds(op, a, objects, &x0, &y0, &x1, &y1) &&
+            (x1 <= clip_x0 || x0 >= clip_x1 || y1 <= clip_y0 || y0 >= clip_y1)) {
+            continue;
+        }
 
-    size_t poly_len;
-    mp_obj_t *polygon;
-    mp_obj_get_array(args[1], &poly_len, &polygon);
+        switch (op) {
+            case DL_FILL:
+                if ((uint8_t)a[1] == 255) {
+                    _fill(self, a[0]);
+                } else {
+                    _fill_rect(self, 0, 0, self->width, self->height, a[0], a[1]);
+                }
+                break;
 
-    self->work = NULL;
+            case DL_PIXEL:
+                draw_pixel(self, a[0], a[1], a[2], a[3]);
+                break;
 
-    if (poly_len > 0) {
-        mp_int_t x = mp_obj_get_int(args[2]);
-        mp_int_t y = mp_obj_get_int(args[3]);
-        OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
-        OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+            case DL_LINE:
+                line(self, a[0], a[1], a[2], a[3], a[4], a[5]);
+                break;
 
-        mp_float_t angle = 0.0;
-        if (n_args > 6) {
-            if (mp_obj_is_float(args[6])) {
-                angle = mp_obj_float_get(args[6]);
-            }
-            if (mp_obj_is_int(args[6])) {
-                angle = (mp_float_t)mp_obj_get_int(args[6]);
-            }
-        }
+            case DL_AA_LINE:
+                aa_line(self, AA_FIXED(a[0]), AA_FIXED(a[1]), AA_FIXED(a[2]), AA_FIXED(a[3]), a[4], a[5], true);
+                break;
 
-        OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, cx, 0)
-        OPTIONAL_ARG(8, mp_int_t, mp_obj_get_int, cy, 0)
+            case DL_HLINE:
+                fast_hline(self, a[0], a[1], a[2], a[3], a[4]);
+                break;
 
-        self->work = m_malloc(poly_len * sizeof(Point));
-        if (self->work) {
-            Point *point = (Point *)self->work;
+            case DL_VLINE:
+                fast_vline(self, a[0], a[1], a[2], a[3], a[4]);
+                break;
 
-            for (int idx = 0; idx < poly_len; idx++) {
-                size_t point_from_poly_len;
-                mp_obj_t *point_from_poly;
-                mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
-                if (point_from_poly_len < 2) {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-                }
+            case DL_RECT:
+                rect(self, a[0], a[1], a[2], a[3], a[4], a[5]);
+                break;
 
-                mp_int_t px = mp_obj_get_int(point_from_poly[0]);
-                mp_int_t py = mp_obj_get_int(point_from_poly[1]);
-                point[idx].x = px;
-                point[idx].y = py;
-            }
+            case DL_FILL_RECT:
+                fill_rect_clipped(self, a[0], a[1], a[2], a[3], a[4], a[5]);
+                break;
 
-            Point center;
-            center.x = cx;
-            center.y = cy;
+            case DL_CIRCLE:
+                circle(self, a[0], a[1], a[2], a[3], a[4]);
+                break;
 
-            Polygon polygon;
-            polygon.length = poly_len;
-            polygon.points = self->work;
+            case DL_FILL_CIRCLE:
+                fill_circle(self, a[0], a[1], a[2], a[3], a[4]);
+                break;
 
-            if (angle > 0) {
-                RotatePolygon(&polygon, center, angle);
-            }
+            case DL_AA_CIRCLE:
+                aa_circle(self, a[0], a[1], a[2], a[3], a[4]);
+                break;
 
-            for (int idx = 1; idx < poly_len; idx++) {
-                line(
-                    self,
-                    (int)point[idx - 1].x + x,
-                    (int)point[idx - 1].y + y,
-                    (int)point[idx].x + x,
-                    (int)point[idx].y + y,
-                    color,
-                    alpha);
-            }
+            case DL_BLIT_BUFFER:
+                blit_clipped(self, objects[a[0]], a[1], a[2], a[3], a[4], a[5]);
+                break;
 
-            m_free(self->work);
-            self->work = NULL;
-        } else {
-            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+            case DL_BLIT_LABEL:
+                label_blit(self, MP_OBJ_TO_PTR(objects[a[0]]), a[1], a[2]);
+                break;
         }
-    } else {
-        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
     }
-    return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_polygon_obj, 4, 9, s3lcd_polygon);
 
-//
-//  filled convex polygon
-//
+static void s3lcd_display_list_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    s3lcd_display_list_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<DisplayList commands=%u, bytes=%u>", (unsigned)self->count, (unsigned)(self->len * sizeof(int16_t)));
+}
 
 ///
-/// .fill_polygon(polygon, x, y {, color, alpha, angle, cx, cy})
-/// Draw a filled polygon.
-/// required parameters:
-/// -- polygon: a list of points [(x1, y1), (x2, y2), ...]
-/// -- x: x coordinate
-/// -- y: y coordinate
-/// optional parameters:
-/// -- color: color
-/// -- alpha: alpha
-/// -- angle: angle to rotate the polygon
-/// -- cx: x coordinate of the center of rotation
-/// -- cy: y coordinate of the center of rotation
+/// s3lcd.DisplayList()
+/// Record draw calls to draw them with the replay() method. The drawing
+/// methods take the same arguments as the ESPLCD methods of the same name
+/// and return the index of the recorded command for the set() method. The
+/// text, write, draw, bitmap and polygon methods record a call of the
+/// ESPLCD method that is made every time the list is drawn.
 ///
 
-static mp_obj_t s3lcd_fill_polygon(size_t n_args, const mp_obj_t *args) {
-    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+static mp_obj_t s3lcd_display_list_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    mp_arg_check_num(n_args, n_kw, 0, 0, false);
+
+    s3lcd_display_list_obj_t *self = m_new_obj(s3lcd_display_list_obj_t);
+    self->base.type = &s3lcd_display_list_type;
+    self->commands = NULL;
+    self->len = 0;
+    self->size = 0;
+    self->starts = NULL;
+    self->count = 0;
+    self->starts_size = 0;
+    self->objects = mp_obj_new_list(0, NULL);
+    return MP_OBJ_FROM_PTR(self);
+}
 
-    size_t poly_len;
-    mp_obj_t *polygon;
-    mp_obj_get_array(args[1], &poly_len, &polygon);
+#define DISPLAY_LIST_METHOD(name, op, n_args_min, n_args_max)                            \
+    static mp_obj_t s3lcd_display_list_##name(size_t n_args, const mp_obj_t *args) {   \
+        return display_list_record(n_args, args, op);                                   \
+    }                                                                                   \
+    static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_display_list_##name##_obj,         \
+        n_args_min, n_args_max, s3lcd_display_list_##name);
+
+DISPLAY_LIST_METHOD(fill, DL_FILL, 1, 3)
+DISPLAY_LIST_METHOD(pixel, DL_PIXEL, 3, 5)
+DISPLAY_LIST_METHOD(line, DL_LINE, 5, 7)
+DISPLAY_LIST_METHOD(aa_line, DL_AA_LINE, 5, 7)
+DISPLAY_LIST_METHOD(hline, DL_HLINE, 4, 6)
+DISPLAY_LIST_METHOD(vline, DL_VLINE, 4, 6)
+DISPLAY_LIST_METHOD(rect, DL_RECT, 5, 7)
+DISPLAY_LIST_METHOD(fill_rect, DL_FILL_RECT, 5, 7)
+DISPLAY_LIST_METHOD(circle, DL_CIRCLE, 4, 6)
+DISPLAY_LIST_METHOD(fill_circle, DL_FILL_CIRCLE, 4, 6)
+DISPLAY_LIST_METHOD(aa_circle, DL_AA_CIRCLE, 4, 6)
+DISPLAY_LIST_METHOD(blit_buffer, DL_BLIT_BUFFER, 6, 7)
+DISPLAY_LIST_METHOD(blit_label, DL_BLIT_LABEL, 4, 4)
+
+#define DISPLAY_LIST_CALL(name, op, n_args_min)                                          \
+    static mp_obj_t s3lcd_display_list_##name(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) { \
+        return display_list_record_call(n_args, args, kw_args, op);                     \
+    }                                                                                   \
+    static MP_DEFINE_CONST_FUN_OBJ_KW(s3lcd_display_list_##name##_obj, n_args_min, s3lcd_display_list_##name);
+
+DISPLAY_LIST_CALL(text, DL_TEXT, 5)
+DISPLAY_LIST_CALL(write, DL_WRITE, 5)
+DISPLAY_LIST_CALL(draw, DL_DRAW, 5)
+DISPLAY_LIST_CALL(bitmap, DL_BITMAP, 4)
+DISPLAY_LIST_CALL(polygon, DL_POLYGON, 4)
+DISPLAY_LIST_CALL(aa_polygon, DL_AA_POLYGON, 4)
+DISPLAY_LIST_CALL(fill_polygon, DL_FILL_POLYGON, 4)
+DISPLAY_LIST_CALL(aa_fill_polygon, DL_AA_FILL_POLYGON, 4)
 
-    self->work = NULL;
+///
+/// .set(index, arg, value {, value ...})
+/// Change arguments of a recorded command.
+/// required parameters:
+/// -- index: index of the command returned when it was recorded
+/// -- arg: index of the first argument to change, 0 for the first argument
+/// -- value: new value of the argument, further values change the
+///    arguments that follow it, only positional arguments of recorded calls
+///    can be changed
+///
 
-    if (poly_len > 0) {
-        mp_int_t x = mp_obj_get_int(args[2]);
-        mp_int_t y = mp_obj_get_int(args[3]);
-        OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, color, WHITE)
-        OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, alpha, 255)
+static mp_obj_t s3lcd_display_list_set(size_t n_args, const mp_obj_t *args) {
+    s3lcd_display_list_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t index = mp_obj_get_int(args[1]);
+    mp_int_t arg = mp_obj_get_int(args[2]);
 
-        mp_float_t angle = 0.0;
-        if (n_args > 6) {
-            if (mp_obj_is_float(args[6])) {
-                angle = mp_obj_float_get(args[6]);
-            }
-            if (mp_obj_is_int(args[6])) {
-                angle = (mp_float_t)mp_obj_get_int(args[6]);
+    if (index < 0 || (size_t)index >= self->count) {
+        mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("command index out of range"));
+    }
+    int16_t *cmd = self->commands + self->starts[index];
+    int op = cmd[0];
+    if (dl_ops[op].method) {
+        // calls change their positional arguments
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_list_get(self->objects, &len, &items);
+        mp_obj_list_get(items[cmd[1]], &len, &items);
+        if (arg < 0 || arg + n_args - 3 > len - 2 * cmd[2]) {
+            mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("argument index out of range"));
+        }
+        for (size_t i = 3; i < n_args; i++, arg++) {
+            if (arg == dl_ops[op].y_arg - 1 || arg == dl_ops[op].y_arg) {
+                mp_obj_get_int(args[i]);
             }
+            items[arg] = args[i];
+        }
+        return mp_const_none;
+    }
+    if (arg < 0 || arg + n_args - 3 > dl_ops[op].args) {
+        mp_raise_msg(&mp_type_IndexError, MP_ERROR_TEXT("argument index out of range"));
+    }
+
+    for (size_t i = 3; i < n_args; i++, arg++) {
+        if (arg == 0 && (op == DL_BLIT_BUFFER || op == DL_BLIT_LABEL)) {
+            display_list_object(op, args[i]);
+            mp_obj_list_store(self->objects, MP_OBJ_NEW_SMALL_INT(cmd[1]), args[i]);
+        } else {
+            cmd[arg + 1] = display_list_arg(op, arg, args[i]);
         }
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_display_list_set_obj, 4, 10, s3lcd_display_list_set);
 
-        OPTIONAL_ARG(7, mp_int_t, mp_obj_get_int, cx, 0)
-        OPTIONAL_ARG(8, mp_int_t, mp_obj_get_int, cy, 0)
+///
+/// .clear()
+/// Remove all recorded commands, keeping the memory for recording again.
+///
 
-        self->work = m_malloc(poly_len * sizeof(Point));
-        if (self->work) {
-            Point *point = (Point *)self->work;
+static mp_obj_t s3lcd_display_list_clear(mp_obj_t self_in) {
+    s3lcd_display_list_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    self->len = 0;
+    self->count = 0;
+    self->objects = mp_obj_new_list(0, NULL);
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_display_list_clear_obj, s3lcd_display_list_clear);
+
+static const mp_rom_map_elem_t s3lcd_display_list_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&s3lcd_display_list_fill_obj)},
+    {MP_ROM_QSTR(MP_QSTR_pixel), MP_ROM_PTR(&s3lcd_display_list_pixel_obj)},
+    {MP_ROM_QSTR(MP_QSTR_line), MP_ROM_PTR(&s3lcd_display_list_line_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_line), MP_ROM_PTR(&s3lcd_display_list_aa_line_obj)},
+    {MP_ROM_QSTR(MP_QSTR_hline), MP_ROM_PTR(&s3lcd_display_list_hline_obj)},
+    {MP_ROM_QSTR(MP_QSTR_vline), MP_ROM_PTR(&s3lcd_display_list_vline_obj)},
+    {MP_ROM_QSTR(MP_QSTR_rect), MP_ROM_PTR(&s3lcd_display_list_rect_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fill_rect), MP_ROM_PTR(&s3lcd_display_list_fill_rect_obj)},
+    {MP_ROM_QSTR(MP_QSTR_circle), MP_ROM_PTR(&s3lcd_display_list_circle_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fill_circle), MP_ROM_PTR(&s3lcd_display_list_fill_circle_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_circle), MP_ROM_PTR(&s3lcd_display_list_aa_circle_obj)},
+    {MP_ROM_QSTR(MP_QSTR_blit_buffer), MP_ROM_PTR(&s3lcd_display_list_blit_buffer_obj)},
+    {MP_ROM_QSTR(MP_QSTR_blit_label), MP_ROM_PTR(&s3lcd_display_list_blit_label_obj)},
+    {MP_ROM_QSTR(MP_QSTR_text), MP_ROM_PTR(&s3lcd_display_list_text_obj)},
+    {MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&s3lcd_display_list_write_obj)},
+    {MP_ROM_QSTR(MP_QSTR_draw), MP_ROM_PTR(&s3lcd_display_list_draw_obj)},
+    {MP_ROM_QSTR(MP_QSTR_bitmap), MP_ROM_PTR(&s3lcd_display_list_bitmap_obj)},
+    {MP_ROM_QSTR(MP_QSTR_polygon), MP_ROM_PTR(&s3lcd_display_list_polygon_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_polygon), MP_ROM_PTR(&s3lcd_display_list_aa_polygon_obj)},
+    {MP_ROM_QSTR(MP_QSTR_fill_polygon), MP_ROM_PTR(&s3lcd_display_list_fill_polygon_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_fill_polygon), MP_ROM_PTR(&s3lcd_display_list_aa_fill_polygon_obj)},
+    {MP_ROM_QSTR(MP_QSTR_set), MP_ROM_PTR(&s3lcd_display_list_set_obj)},
+    {MP_ROM_QSTR(MP_QSTR_clear), MP_ROM_PTR(&s3lcd_display_list_clear_obj)},
+};
+static MP_DEFINE_CONST_DICT(s3lcd_display_list_locals_dict, s3lcd_display_list_locals_dict_table);
 
-            for (int idx = 0; idx < poly_len; idx++) {
-                size_t point_from_poly_len;
-                mp_obj_t *point_from_poly;
-                mp_obj_get_array(polygon[idx], &point_from_poly_len, &point_from_poly);
-                if (point_from_poly_len < 2) {
-                    mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-                }
+#if MICROPY_OBJ_TYPE_REPR == MICROPY_OBJ_TYPE_REPR_SLOT_INDEX
 
-                point[idx].x = mp_obj_get_int(point_from_poly[0]);
-                point[idx].y = mp_obj_get_int(point_from_poly[1]);
-            }
+MP_DEFINE_CONST_OBJ_TYPE(
+    s3lcd_display_list_type,
+    MP_QSTR_DisplayList,
+    MP_TYPE_FLAG_NONE,
+    print, s3lcd_display_list_print,
+    make_new, s3lcd_display_list_make_new,
+    locals_dict, &s3lcd_display_list_locals_dict);
 
-            Point center = {cx, cy};
-            Polygon polygon = {poly_len, self->work};
+#else
 
-            if (angle != 0) {
-                RotatePolygon(&polygon, center, angle);
-            }
+const mp_obj_type_t s3lcd_display_list_type = {
+    {&mp_type_type},
+    .name = MP_QSTR_DisplayList,
+    .print = s3lcd_display_list_print,
+    .make_new = s3lcd_display_list_make_new,
+    .locals_dict = (mp_obj_dict_t *)&s3lcd_display_list_locals_dict,
+};
 
-            Point location = {x, y};
-            PolygonFill(self, &polygon, location, color, alpha);
+#endif
 
-            m_free(self->work);
-            self->work = NULL;
-        } else {
-            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
-        }
+///
+/// .replay(display_list {, x, y, w, h})
+/// Draw the commands recorded in a DisplayList.
+/// required parameters:
+/// -- display_list: a DisplayList object
+/// optional parameters:
+/// -- x, y, w, h: area being redrawn, commands that draw entirely outside
+///    of it are skipped, defaults to the whole frame buffer
+///
 
-    } else {
-        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("Polygon data error"));
+static mp_obj_t s3lcd_replay(size_t n_args, const mp_obj_t *args) {
+    s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    frame_buffer_required(self);
+    if (!mp_obj_is_type(args[1], &s3lcd_display_list_type)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("replay requires a DisplayList"));
     }
+    s3lcd_display_list_obj_t *dl = MP_OBJ_TO_PTR(args[1]);
+    OPTIONAL_ARG(2, mp_int_t, mp_obj_get_int, x, 0)
+    OPTIONAL_ARG(3, mp_int_t, mp_obj_get_int, y, 0)
+    OPTIONAL_ARG(4, mp_int_t, mp_obj_get_int, w, self->width)
+    OPTIONAL_ARG(5, mp_int_t, mp_obj_get_int, h, self->height)
+
+    display_list_replay(self, dl, x, y, x + w, y + h, 0);
     return mp_const_none;
 }
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_fill_polygon_obj, 4, 9, s3lcd_fill_polygon);
-
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_replay_obj, 2, 6, s3lcd_replay);
 
 //
 // copy rows from the framebuffer to the dma buffer and send it to the display beginning at row.
@@ -2627,13 +6433,54 @@ void s3lcd_dma_display(s3lcd_obj_t *self, uint16_t *src, uint16_t row, uint16_t
     }
 }
 
+//
+// show_display_list: draw a display list one dma strip at a time with a
+// display object whose frame buffer is the strip, sending each strip to the
+// display while the next one is drawn in the other dma buffer.
+//
+
+static void show_display_list(s3lcd_obj_t *self, s3lcd_display_list_obj_t *dl) {
+    direct_t direct;
+    direct_init(&direct, self, 0, self->width);
+
+    // wrapping inside a strip would draw in the wrong place
+    s3lcd_obj_t strip = *self;
+    strip.options &= ~OPTIONS_WRAP;
+
+    for (int y = 0; y < self->height; y += self->dma_rows) {
+        int rows = (self->height - y < self->dma_rows) ? self->height - y : self->dma_rows;
+        strip.frame_buffer = direct.buffers[direct.buffer];
+        strip.frame_buffer_size = rows * self->width * sizeof(uint16_t);
+        strip.height = rows;
+
+        _fill(&strip, BLACK);
+        display_list_replay(&strip, dl, 0, 0, strip.width, rows, y);
+        direct_send(&direct, y, rows, strip.frame_buffer);
+    }
+    direct_done(&direct);
+}
+
 ///
-/// .show()
-/// Show the framebuffer.
+/// .show({display_list})
+/// Show the framebuffer, or draw a DisplayList directly to the display one
+/// dma strip at a time without using the framebuffer.
+/// optional parameters:
+/// -- display_list: a DisplayList object, required without a framebuffer
 ///
 
 static mp_obj_t s3lcd_show(size_t n_args, const mp_obj_t *args) {
     s3lcd_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    if (n_args > 1) {
+        if (!mp_obj_is_type(args[1], &s3lcd_display_list_type)) {
+            mp_raise_TypeError(MP_ERROR_TEXT("show requires a DisplayList"));
+        }
+        show_display_list(self, MP_OBJ_TO_PTR(args[1]));
+        return mp_const_none;
+    }
+    if (self->frame_buffer == NULL) {
+        mp_raise_ValueError(MP_ERROR_TEXT("show requires a DisplayList without a framebuffer"));
+    }
+
     size_t pixels = self->dma_rows * self->width;
     uint16_t *fb = self->frame_buffer;
     for (int y = 0; y < self->height - self->dma_rows + 1; y += self->dma_rows) {
@@ -2649,7 +6496,7 @@ static mp_obj_t s3lcd_show(size_t n_args, const mp_obj_t *args) {
     return mp_const_none;
 }
 
-static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_show_obj, 1, 1, s3lcd_show);
+static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_show_obj, 1, 2, s3lcd_show);
 
 ///
 /// .deinit()
@@ -2677,12 +6524,17 @@ static mp_obj_t s3lcd_deinit(size_t n_args, const mp_obj_t *args) {
     m_free(self->work);
     self->work = NULL;
 
+    s3lcd_glyph_cache_free(self->glyph_cache);
+    self->glyph_cache = NULL;
+
     m_free(self->frame_buffer);
     self->frame_buffer = NULL;
     self->frame_buffer_size = 0;
 
     free(self->dma_buffer);
     self->dma_buffer = NULL;
+    free(self->strip_buffer);
+    self->strip_buffer = NULL;
     self->dma_buffer_size = 0;
     self->dma_rows = 0;
 
@@ -2692,25 +6544,36 @@ static MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(s3lcd_deinit_obj, 1, 1, s3lcd_deinit)
 
 static const mp_rom_map_elem_t s3lcd_locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_write), MP_ROM_PTR(&s3lcd_write_obj)},
+    {MP_ROM_QSTR(MP_QSTR_write_box), MP_ROM_PTR(&s3lcd_write_box_obj)},
+    {MP_ROM_QSTR(MP_QSTR_write_sdf), MP_ROM_PTR(&s3lcd_write_sdf_obj)},
+    {MP_ROM_QSTR(MP_QSTR_blit_label), MP_ROM_PTR(&s3lcd_blit_label_obj)},
+    {MP_ROM_QSTR(MP_QSTR_replay), MP_ROM_PTR(&s3lcd_replay_obj)},
     {MP_ROM_QSTR(MP_QSTR_write_len), MP_ROM_PTR(&s3lcd_write_len_obj)},
+    {MP_ROM_QSTR(MP_QSTR_glyph_cache), MP_ROM_PTR(&s3lcd_glyph_cache_obj)},
     {MP_ROM_QSTR(MP_QSTR_reset), MP_ROM_PTR(&s3lcd_reset_obj)},
     {MP_ROM_QSTR(MP_QSTR_inversion_mode), MP_ROM_PTR(&s3lcd_inversion_mode_obj)},
     {MP_ROM_QSTR(MP_QSTR_idle_mode), MP_ROM_PTR(&s3lcd_idle_mode_obj)},
     {MP_ROM_QSTR(MP_QSTR_map_bitarray_to_rgb565), MP_ROM_PTR(&s3lcd_map_bitarray_to_rgb565_obj)},
     {MP_ROM_QSTR(MP_QSTR_init), MP_ROM_PTR(&s3lcd_init_obj)},
     {MP_ROM_QSTR(MP_QSTR_pixel), MP_ROM_PTR(&s3lcd_pixel_obj)},
+    {MP_ROM_QSTR(MP_QSTR_pixels), MP_ROM_PTR(&s3lcd_pixels_obj)},
     {MP_ROM_QSTR(MP_QSTR_line), MP_ROM_PTR(&s3lcd_line_obj)},
+    {MP_ROM_QSTR(MP_QSTR_lines), MP_ROM_PTR(&s3lcd_lines_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_line), MP_ROM_PTR(&s3lcd_aa_line_obj)},
     {MP_ROM_QSTR(MP_QSTR_blit_buffer), MP_ROM_PTR(&s3lcd_blit_buffer_obj)},
+    {MP_ROM_QSTR(MP_QSTR_blits), MP_ROM_PTR(&s3lcd_blits_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw), MP_ROM_PTR(&s3lcd_draw_obj)},
     {MP_ROM_QSTR(MP_QSTR_draw_len), MP_ROM_PTR(&s3lcd_draw_len_obj)},
     {MP_ROM_QSTR(MP_QSTR_bitmap), MP_ROM_PTR(&s3lcd_bitmap_obj)},
     {MP_ROM_QSTR(MP_QSTR_fill_rect), MP_ROM_PTR(&s3lcd_fill_rect_obj)},
+    {MP_ROM_QSTR(MP_QSTR_rects), MP_ROM_PTR(&s3lcd_rects_obj)},
     {MP_ROM_QSTR(MP_QSTR_clear), MP_ROM_PTR(&s3lcd_clear_obj)},
     {MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&s3lcd_fill_obj)},
     {MP_ROM_QSTR(MP_QSTR_hline), MP_ROM_PTR(&s3lcd_hline_obj)},
     {MP_ROM_QSTR(MP_QSTR_vline), MP_ROM_PTR(&s3lcd_vline_obj)},
     {MP_ROM_QSTR(MP_QSTR_fill_circle), MP_ROM_PTR(&s3lcd_fill_circle_obj)},
     {MP_ROM_QSTR(MP_QSTR_circle), MP_ROM_PTR(&s3lcd_circle_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_circle), MP_ROM_PTR(&s3lcd_aa_circle_obj)},
     {MP_ROM_QSTR(MP_QSTR_rect), MP_ROM_PTR(&s3lcd_rect_obj)},
     {MP_ROM_QSTR(MP_QSTR_text), MP_ROM_PTR(&s3lcd_text_obj)},
     {MP_ROM_QSTR(MP_QSTR_rotation), MP_ROM_PTR(&s3lcd_rotation_obj)},
@@ -2725,7 +6588,9 @@ static const mp_rom_map_elem_t s3lcd_locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_png_write), MP_ROM_PTR(&s3lcd_png_write_obj)},
     {MP_ROM_QSTR(MP_QSTR_polygon_center), MP_ROM_PTR(&s3lcd_polygon_center_obj)},
     {MP_ROM_QSTR(MP_QSTR_polygon), MP_ROM_PTR(&s3lcd_polygon_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_polygon), MP_ROM_PTR(&s3lcd_aa_polygon_obj)},
     {MP_ROM_QSTR(MP_QSTR_fill_polygon), MP_ROM_PTR(&s3lcd_fill_polygon_obj)},
+    {MP_ROM_QSTR(MP_QSTR_aa_fill_polygon), MP_ROM_PTR(&s3lcd_aa_fill_polygon_obj)},
     {MP_ROM_QSTR(MP_QSTR_show), MP_ROM_PTR(&s3lcd_show_obj)},
     {MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&s3lcd_deinit_obj)},
 };
@@ -2799,8 +6664,10 @@ mp_obj_t s3lcd_make_new(const mp_obj_type_t *type,
         ARG_custom_init,
         ARG_color_space,
         ARG_inversion_mode,
+        ARG_idle_mode,
         ARG_dma_rows,
         ARG_options,
+        ARG_frame_buffer,
     };
 
     static const mp_arg_t allowed_args[] = {
@@ -2816,6 +6683,7 @@ mp_obj_t s3lcd_make_new(const mp_obj_type_t *type,
         {MP_QSTR_idle_mode, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = true}},
         {MP_QSTR_dma_rows, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 16}},
         {MP_QSTR_options, MP_ARG_INT | MP_ARG_KW_ONLY, {.u_int = 0}},
+        {MP_QSTR_frame_buffer, MP_ARG_BOOL | MP_ARG_KW_ONLY, {.u_bool = true}},
     };
 
     mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
@@ -2831,6 +6699,8 @@ mp_obj_t s3lcd_make_new(const mp_obj_type_t *type,
     self->width = args[ARG_width].u_int;
     self->height = args[ARG_height].u_int;
 
+    unpack_lut_init();
+
     uint16_t longest_axis = ((self->width > self->height) ? self->width : self->height);
     self->dma_rows = args[ARG_dma_rows].u_int;
     self->dma_buffer_size = self->dma_rows * longest_axis * 2;
@@ -2839,6 +6709,7 @@ mp_obj_t s3lcd_make_new(const mp_obj_type_t *type,
     if (self->dma_buffer == NULL) {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Failed to allocate DMA buffer"));
     }
+    self->strip_buffer = NULL;
 
     self->rotations = set_rotations(self->width, self->height);
     self->rotations_len = 4;
@@ -2872,8 +6743,9 @@ mp_obj_t s3lcd_make_new(const mp_obj_type_t *type,
     self->color_space = args[ARG_color_space].u_int;
     self->inversion_mode = args[ARG_inversion_mode].u_bool;
     self->options = args[ARG_options].u_int & 0xff;
-    self->frame_buffer_size = self->width * self->height * 2;
+    self->frame_buffer_size = (args[ARG_frame_buffer].u_bool) ? self->width * self->height * 2 : 0;
     self->frame_buffer = NULL;
+    self->glyph_cache = NULL;
     return MP_OBJ_FROM_PTR(self);
 }
 
@@ -2881,7 +6753,13 @@ static const mp_map_elem_t s3lcd_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR___name__), MP_OBJ_NEW_QSTR(MP_QSTR_s3lcd)},
     {MP_ROM_QSTR(MP_QSTR_color565), (mp_obj_t)&s3lcd_color565_obj},
     {MP_ROM_QSTR(MP_QSTR_map_bitarray_to_rgb565), (mp_obj_t)&s3lcd_map_bitarray_to_rgb565_obj},
+    {MP_ROM_QSTR(MP_QSTR_hit_test), (mp_obj_t)&s3lcd_hit_test_obj},
     {MP_ROM_QSTR(MP_QSTR_ESPLCD), (mp_obj_t)&s3lcd_type},
+    {MP_ROM_QSTR(MP_QSTR_Font), (mp_obj_t)&s3lcd_font_type},
+    {MP_ROM_QSTR(MP_QSTR_Hershey), (mp_obj_t)&s3lcd_hershey_type},
+    {MP_ROM_QSTR(MP_QSTR_Label), (mp_obj_t)&s3lcd_label_type},
+    {MP_ROM_QSTR(MP_QSTR_Polygon), (mp_obj_t)&s3lcd_polygon_type},
+    {MP_ROM_QSTR(MP_QSTR_DisplayList), (mp_obj_t)&s3lcd_display_list_type},
     {MP_ROM_QSTR(MP_QSTR_I80_BUS), (mp_obj_t)&s3lcd_i80_bus_type},
     {MP_ROM_QSTR(MP_QSTR_SPI_BUS), (mp_obj_t)&s3lcd_spi_bus_type},
 
@@ -2899,7 +6777,13 @@ static const mp_map_elem_t s3lcd_module_globals_table[] = {
     {MP_ROM_QSTR(MP_QSTR_TRANSPARENT), MP_ROM_INT(-1)},
     {MP_ROM_QSTR(MP_QSTR_WRAP), MP_ROM_INT(OPTIONS_WRAP)},
     {MP_ROM_QSTR(MP_QSTR_WRAP_H), MP_ROM_INT(OPTIONS_WRAP_H)},
-    {MP_ROM_QSTR(MP_QSTR_WRAP_V), MP_ROM_INT(OPTIONS_WRAP_V)}
+    {MP_ROM_QSTR(MP_QSTR_WRAP_V), MP_ROM_INT(OPTIONS_WRAP_V)},
+    {MP_ROM_QSTR(MP_QSTR_FIXED_ROTATE), MP_ROM_INT(OPTIONS_FIXED_ROTATE)},
+    {MP_ROM_QSTR(MP_QSTR_LEFT), MP_ROM_INT(ALIGN_LEFT)},
+    {MP_ROM_QSTR(MP_QSTR_CENTER), MP_ROM_INT(ALIGN_CENTER)},
+    {MP_ROM_QSTR(MP_QSTR_RIGHT), MP_ROM_INT(ALIGN_RIGHT)},
+    {MP_ROM_QSTR(MP_QSTR_EVEN_ODD), MP_ROM_INT(FILL_EVEN_ODD)},
+    {MP_ROM_QSTR(MP_QSTR_NON_ZERO), MP_ROM_INT(FILL_NON_ZERO)}
 };
 
 static MP_DEFINE_CONST_DICT(mp_module_s3lcd_globals, s3lcd_module_globals_table);
@@ -4,6 +4,7 @@
 
 #include "esp_lcd_panel_io.h"
 #include "mpfile.h"
+#include "s3lcd_font.h"
 
 //
 // Default Values for T-Display-S3 170x320 ST7796
@@ -49,6 +50,16 @@
 #define OPTIONS_WRAP_V 0x01
 #define OPTIONS_WRAP_H 0x02
 #define OPTIONS_WRAP   0x03
+#define OPTIONS_FIXED_ROTATE 0x04
+
+// write_box alignment
+#define ALIGN_LEFT   0
+#define ALIGN_CENTER 1
+#define ALIGN_RIGHT  2
+
+// fill_polygon fill rules
+#define FILL_EVEN_ODD 0
+#define FILL_NON_ZERO 1
 
 // scroll directions
 #define SCROLL_UP 0
@@ -64,8 +75,22 @@ typedef struct _Point {
 typedef struct _Polygon {
     int length;
     Point *points;
+    int contours;       // number of contours, 0 for a single contour
+    int *ends;          // index after the last point of each contour
 } Polygon;
 
+// polygon vertices packed as x, y pairs in 24.8 fixed point
+
+#define VERTEX_SHIFT 8
+#define VERTEX_LIMIT 32767                  // largest vertex coordinate in pixels
+
+typedef struct _s3lcd_vertices_t {
+    int32_t *xy;        // x, y pairs in 24.8 fixed point
+    int length;         // number of vertices
+    int contours;       // number of contours
+    int *ends;          // index after the last vertex of each contour
+} s3lcd_vertices_t;
+
 typedef union _bus_handle_t {
     esp_lcd_i80_bus_handle_t i80;
     esp_lcd_spi_bus_handle_t spi;
@@ -97,6 +122,7 @@ typedef struct _s3lcd_obj_t {
     uint16_t dma_rows;                      // dma transfer buffer height in rows
     uint16_t *dma_buffer;                   // dma transfer buffer
     size_t dma_buffer_size;                 // dma transfer buffer size in bytes
+    uint16_t *strip_buffer;                 // second dma buffer for drawing display lists in strips
     uint16_t *work_buffer;                  // work frame buffer
     void *work;                             // work buffer for jpg & png decoding
     uint8_t *scanline_ringbuf;              // png scanline_ringbuf
@@ -110,10 +136,71 @@ typedef struct _s3lcd_obj_t {
     mp_obj_t custom_init;                   // custom init sequence
     uint8_t rotations_len;                  // number of rotations
     uint8_t options;                        // options bit array: wrap (optional)
+    s3lcd_glyph_cache_t *glyph_cache;       // decoded glyph cache or NULL
 	gpio_num_t rst;
     bool swap_color_bytes;                  // swap color bytes (SPI only, I80 is builtin)
 } s3lcd_obj_t;
 
+// Text rendered once into its own buffer
+
+typedef struct _s3lcd_label_obj_t {
+    mp_obj_base_t base;                     // base class
+    mp_obj_t font_obj;                      // font module or Font object
+    s3lcd_font_obj_t font_buf;              // font resolved from a font module
+    s3lcd_font_obj_t *font;                 // font used to render the text
+    mp_obj_t text;                          // rendered text
+    mp_int_t fg_color;                      // foreground color
+    mp_int_t bg_color;                      // background color or -1 for transparent
+    uint8_t alpha;                          // alpha used when blitting
+    bool aa;                                // anti-aliased rendering
+    uint16_t width;                         // width of the rendered text in pixels
+    uint16_t height;                        // height of the rendered text in pixels
+    void *buffer;                           // RGB565 pixels, or fg coverage if bg is transparent
+    size_t buffer_size;                     // buffer size in bytes
+} s3lcd_label_obj_t;
+
+extern const mp_obj_type_t s3lcd_label_type;
+
+// Polygon parsed once for the polygon drawing methods
+
+#define POLYGON_POSES 2                     // rotations cached by a Polygon
+
+typedef struct _s3lcd_polygon_pose_t {
+    Point *points;                          // vertices rotated to this pose
+    Point min;                              // top left corner of the rotated bounds
+    Point max;                              // bottom right corner of the rotated bounds
+    mp_float_t angle;                       // angle of the rotation, 0 if none
+    Point center;                           // center of the rotation
+    bool fixed;                             // rotated with the fixed point sine table
+    bool valid;                             // points hold this pose
+} s3lcd_polygon_pose_t;
+
+typedef struct _s3lcd_polygon_obj_t {
+    mp_obj_base_t base;                     // base class
+    s3lcd_vertices_t vertices;              // packed vertices and contour ends
+    Point min;                              // top left corner of the bounds
+    Point max;                              // bottom right corner of the bounds
+    s3lcd_polygon_pose_t poses[POLYGON_POSES];
+    int recent;                             // index of the most recently used pose
+} s3lcd_polygon_obj_t;
+
+extern const mp_obj_type_t s3lcd_polygon_type;
+
+// Draw calls recorded for the replay() method
+
+typedef struct _s3lcd_display_list_obj_t {
+    mp_obj_base_t base;                     // base class
+    int16_t *commands;                      // opcode followed by the arguments of each command
+    size_t len;                             // int16 values used in commands
+    size_t size;                            // int16 values allocated for commands
+    uint32_t *starts;                       // offset of each command in commands
+    size_t count;                           // number of commands
+    size_t starts_size;                     // entries allocated for starts
+    mp_obj_t objects;                       // list of buffers and labels drawn by the commands
+} s3lcd_display_list_obj_t;
+
+extern const mp_obj_type_t s3lcd_display_list_type;
+
 mp_obj_t s3lcd_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args);
 
 extern void draw_pixel(s3lcd_obj_t *self, int16_t x, int16_t y, uint16_t color, uint8_t alpha);
@@ -0,0 +1,638 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "py/obj.h"
+#include "py/objstr.h"
+#include "py/runtime.h"
+
+#include "s3lcd_font.h"
+#include "s3lcd_ttf.h"
+
+//
+// resolve the font data from a font module created by the font2bitmap utility
+//
+
+void s3lcd_font_from_module(s3lcd_font_obj_t *font, mp_obj_t module) {
+    if (!mp_obj_is_type(module, &mp_type_module)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("font requires a font module"));
+    }
+
+    mp_obj_module_t *mod = MP_OBJ_TO_PTR(module);
+    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(mod->globals);
+    mp_buffer_info_t bufinfo;
+
+    font->module = module;
+    font->bpp = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BPP)));
+    font->height = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_HEIGHT)));
+    font->offset_width = mp_obj_get_int(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSET_WIDTH)));
+    if (font->bpp < 1 || font->bpp > 8) {
+        mp_raise_ValueError(MP_ERROR_TEXT("font BPP must be 1 to 8"));
+    }
+
+    // distance field fonts created by the font2sdf utility
+    mp_map_elem_t *spread = mp_map_lookup(&dict->map, MP_OBJ_NEW_QSTR(MP_QSTR_SPREAD), MP_MAP_LOOKUP);
+    font->spread = spread ? mp_obj_get_int(spread->value) : 0;
+    if (font->spread && (font->bpp != 8 || font->spread * 2 >= font->height)) {
+        mp_raise_ValueError(MP_ERROR_TEXT("invalid distance field font"));
+    }
+
+    mp_get_buffer_raise(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_WIDTHS)), &bufinfo, MP_BUFFER_READ);
+    font->widths = bufinfo.buf;
+
+    mp_get_buffer_raise(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_OFFSETS)), &bufinfo, MP_BUFFER_READ);
+    font->offsets = bufinfo.buf;
+
+    mp_get_buffer_raise(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_BITMAPS)), &bufinfo, MP_BUFFER_READ);
+    font->bitmaps = bufinfo.buf;
+
+    mp_obj_t map_obj = mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_MAP));
+    GET_STR_DATA_LEN(map_obj, map_data, map_len);
+    font->map = map_data;
+    font->map_len = map_len;
+    font->count = 0;
+    font->index = NULL;
+    font->file = NULL;
+    font->ttf = NULL;
+}
+
+//
+// return the compiled font for a Font object, or resolve a font module into
+// font_buf and return that.
+//
+
+s3lcd_font_obj_t *s3lcd_font_get(mp_obj_t font_in, s3lcd_font_obj_t *font_buf) {
+    if (mp_obj_is_type(font_in, &s3lcd_font_type)) {
+        return MP_OBJ_TO_PTR(font_in);
+    }
+    s3lcd_font_from_module(font_buf, font_in);
+    return font_buf;
+}
+
+//
+// Font files
+//
+// Font files created by the font2bin utility hold the glyph codepoints,
+// widths, offsets and bitmaps of a font2bitmap font module in sections after
+// a small header. Only the header is read when the file is opened; codepoint
+// lookups and widths are read through a small cache of file blocks and glyph
+// bitmaps are read into a buffer when they are drawn.
+//
+
+//
+// copy len bytes at file position pos into dst through the block cache.
+//
+
+void s3lcd_font_file_read(s3lcd_font_file_t *file, uint32_t pos, uint8_t *dst, size_t len) {
+    while (len) {
+        uint32_t block_pos = pos & ~(FONT_BLOCK_SIZE - 1);
+        s3lcd_font_block_t *block = NULL;
+        s3lcd_font_block_t *oldest = &file->blocks[0];
+
+        for (int i = 0; i < FONT_BLOCKS; i++) {
+            if (file->blocks[i].pos == block_pos) {
+                block = &file->blocks[i];
+                break;
+            }
+            if (file->blocks[i].used < oldest->used) {
+                oldest = &file->blocks[i];
+            }
+        }
+
+        if (block == NULL) {
+            block = oldest;
+            mp_seek(file->fp, block_pos, MP_SEEK_SET);
+            block->pos = block_pos;
+            block->len = mp_readinto(file->fp, block->data, FONT_BLOCK_SIZE);
+        }
+        block->used = ++file->used;
+
+        uint32_t start = pos - block_pos;
+        if (start >= block->len) {
+            mp_raise_ValueError(MP_ERROR_TEXT("font file is truncated"));
+        }
+
+        size_t run = block->len - start;
+        if (run > len) {
+            run = len;
+        }
+        memcpy(dst, block->data + start, run);
+        dst += run;
+        pos += run;
+        len -= run;
+    }
+}
+
+static uint32_t font_file_u32(s3lcd_font_file_t *file, uint32_t pos) {
+    uint8_t b[4];
+    s3lcd_font_file_read(file, pos, b, 4);
+    return b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+//
+// open filename and return a font file with an empty block cache.
+//
+
+s3lcd_font_file_t *s3lcd_font_file_new(const char *filename) {
+    s3lcd_font_file_t *file = m_new_obj(s3lcd_font_file_t);
+    memset(file, 0, sizeof(s3lcd_font_file_t));
+    for (int i = 0; i < FONT_BLOCKS; i++) {
+        file->blocks[i].pos = UINT32_MAX;
+    }
+    file->glyph_index = -1;
+    file->fp = mp_open(filename, "rb");
+    return file;
+}
+
+//
+// open a font file and read its header into font.
+//
+
+static void font_file_open(s3lcd_font_obj_t *font, const char *filename) {
+    s3lcd_font_file_t *file = s3lcd_font_file_new(filename);
+
+    uint8_t header[FONT_FILE_HEADER_SIZE];
+    if (mp_readinto(file->fp, header, FONT_FILE_HEADER_SIZE) != FONT_FILE_HEADER_SIZE
+        || memcmp(header, FONT_FILE_MAGIC, 4) != 0
+        || header[4] != FONT_FILE_VERSION) {
+        mp_close(file->fp);
+        mp_raise_ValueError(MP_ERROR_TEXT("not a font file"));
+    }
+
+    uint8_t max_width = header[7];
+    uint32_t count = header[8] | header[9] << 8 | header[10] << 16 | (uint32_t)header[11] << 24;
+
+    font->module = MP_OBJ_FROM_PTR(font);
+    font->bpp = header[5];
+    font->height = header[6];
+    font->offset_width = 4;
+    font->spread = 0;
+    if (font->bpp < 1 || font->bpp > 8 || count == 0 || count > UINT16_MAX) {
+        mp_close(file->fp);
+        mp_raise_ValueError(MP_ERROR_TEXT("not a font file"));
+    }
+
+    file->codepoints_pos = FONT_FILE_HEADER_SIZE;
+    file->widths_pos = file->codepoints_pos + count * 4;
+    file->offsets_pos = file->widths_pos + ((count + 3) & ~3);
+    file->bitmaps_pos = file->offsets_pos + count * 4;
+
+    // room for the largest glyph plus a partial byte at each end
+    file->glyph_size = (max_width * font->height * font->bpp + 7) / 8 + 2;
+    file->glyph = m_new(uint8_t, file->glyph_size);
+
+    font->widths = NULL;
+    font->offsets = NULL;
+    font->bitmaps = NULL;
+    font->map = NULL;
+    font->map_len = 0;
+    font->count = count;
+    font->index = NULL;
+    font->file = file;
+    font->ttf = NULL;
+}
+
+//
+// return the glyph index of ch or -1 if the font does not contain it.
+//
+
+int s3lcd_font_glyph(const s3lcd_font_obj_t *font, unichar ch) {
+    if (font->ttf) {
+        return s3lcd_ttf_glyph(font, ch);
+    }
+
+    if (font->file) {
+        s3lcd_font_file_t *file = font->file;
+        int lo = 0;
+        int hi = font->count - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            uint32_t codepoint = font_file_u32(file, file->codepoints_pos + mid * 4);
+            if (codepoint < ch) {
+                lo = mid + 1;
+            } else if (codepoint > ch) {
+                hi = mid - 1;
+            } else {
+                return mid;
+            }
+        }
+        return -1;
+    }
+
+    if (font->index) {
+        const s3lcd_glyph_index_t *index = font->index;
+        uint32_t first = index[0].codepoint;
+
+        // contiguous ranges like 0x20-0x7f are indexed directly
+        if (ch >= first && ch - first < font->count && index[ch - first].codepoint == ch) {
+            return index[ch - first].index;
+        }
+
+        int lo = 0;
+        int hi = font->count - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            if (index[mid].codepoint < ch) {
+                lo = mid + 1;
+            } else if (index[mid].codepoint > ch) {
+                hi = mid - 1;
+            } else {
+                return index[mid].index;
+            }
+        }
+        return -1;
+    }
+
+    const byte *map_s = font->map, *map_top = font->map + font->map_len;
+    int char_index = 0;
+
+    while (map_s < map_top) {
+        unichar map_ch = utf8_get_char(map_s);
+        map_s = utf8_next_char(map_s);
+        if (ch == map_ch) {
+            return char_index;
+        }
+        char_index++;
+    }
+    return -1;
+}
+
+//
+// return the bit offset of glyph char_index from a font's OFFSETS table.
+//
+
+static uint32_t glyph_offset(const uint8_t *offsets_data, uint8_t offset_width, uint32_t char_index) {
+    const uint8_t *p = offsets_data + char_index * offset_width;
+    uint32_t offset = 0;
+
+    while (offset_width--) {
+        offset = (offset << 8) | *p++;
+    }
+    return offset;
+}
+
+//
+// return the width in pixels of glyph char_index.
+//
+
+uint8_t s3lcd_font_width(const s3lcd_font_obj_t *font, int char_index) {
+    if (font->ttf) {
+        return s3lcd_ttf_width(font, char_index);
+    }
+    if (font->file) {
+        uint8_t width;
+        s3lcd_font_file_read(font->file, font->file->widths_pos + char_index, &width, 1);
+        return width;
+    }
+    return font->widths[char_index];
+}
+
+//
+// return the width in pixels of the bitmap of glyph char_index and set left
+// to the offset of its first column from the pen position. Only TrueType
+// glyphs have bitmaps that differ from their advance.
+//
+
+uint8_t s3lcd_font_box(const s3lcd_font_obj_t *font, int char_index, int *left) {
+    if (font->ttf) {
+        return s3lcd_ttf_box(font, char_index, left);
+    }
+    *left = 0;
+    return s3lcd_font_width(font, char_index);
+}
+
+//
+// point bs at the packed bitmap of glyph char_index.
+//
+
+void s3lcd_font_bitmap(const s3lcd_font_obj_t *font, int char_index, bitstream_t *bs) {
+    if (font->ttf) {
+        s3lcd_ttf_bitmap(font, char_index, bs);
+        return;
+    }
+
+    if (font->file == NULL) {
+        bs->data = font->bitmaps;
+        bs->bit = glyph_offset(font->offsets, font->offset_width, char_index);
+        return;
+    }
+
+    s3lcd_font_file_t *file = font->file;
+    uint32_t offset = font_file_u32(file, file->offsets_pos + char_index * 4);
+    bs->data = file->glyph;
+    bs->bit = offset & 7;
+
+    if (char_index != file->glyph_index) {
+        uint8_t width = s3lcd_font_width(font, char_index);
+        size_t len = (bs->bit + width * font->height * font->bpp + 7) / 8;
+        if (len > file->glyph_size) {
+            mp_raise_ValueError(MP_ERROR_TEXT("font file is corrupt"));
+        }
+
+        file->glyph_index = -1;
+        mp_seek(file->fp, file->bitmaps_pos + (offset >> 3), MP_SEEK_SET);
+        if ((size_t)mp_readinto(file->fp, file->glyph, len) != len) {
+            mp_raise_ValueError(MP_ERROR_TEXT("font file is truncated"));
+        }
+        file->glyph_index = char_index;
+    }
+}
+
+//
+// Glyph cache
+//
+// Decoded glyphs are kept with one pixel index per byte so drawing a cached
+// glyph is a span copy through the palette. Entries are found through a small
+// hash table and kept in a most recently used list; when adding a glyph would
+// exceed the cache size the least recently used entries are freed.
+//
+
+static inline uint32_t glyph_cache_hash(mp_obj_t font, uint32_t codepoint) {
+    return (((uintptr_t)font >> 3) ^ (codepoint * 31)) & (GLYPH_CACHE_BUCKETS - 1);
+}
+
+static void glyph_cache_unlink(s3lcd_glyph_cache_t *cache, s3lcd_glyph_t *glyph) {
+    if (glyph->prev) {
+        glyph->prev->next = glyph->next;
+    } else {
+        cache->head = glyph->next;
+    }
+
+    if (glyph->next) {
+        glyph->next->prev = glyph->prev;
+    } else {
+        cache->tail = glyph->prev;
+    }
+}
+
+static void glyph_cache_push(s3lcd_glyph_cache_t *cache, s3lcd_glyph_t *glyph) {
+    glyph->prev = NULL;
+    glyph->next = cache->head;
+    if (cache->head) {
+        cache->head->prev = glyph;
+    }
+    cache->head = glyph;
+    if (cache->tail == NULL) {
+        cache->tail = glyph;
+    }
+}
+
+static void glyph_cache_evict(s3lcd_glyph_cache_t *cache) {
+    s3lcd_glyph_t *glyph = cache->tail;
+    s3lcd_glyph_t **link = &cache->buckets[glyph_cache_hash(glyph->font, glyph->codepoint)];
+
+    while (*link != glyph) {
+        link = &(*link)->chain;
+    }
+    *link = glyph->chain;
+
+    glyph_cache_unlink(cache, glyph);
+    cache->used -= sizeof(s3lcd_glyph_t) + glyph->width * glyph->height;
+    m_free(glyph);
+}
+
+s3lcd_glyph_cache_t *s3lcd_glyph_cache_new(size_t size) {
+    s3lcd_glyph_cache_t *cache = m_new_obj(s3lcd_glyph_cache_t);
+    memset(cache, 0, sizeof(s3lcd_glyph_cache_t));
+    cache->size = size;
+    return cache;
+}
+
+void s3lcd_glyph_cache_free(s3lcd_glyph_cache_t *cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    while (cache->tail) {
+        glyph_cache_evict(cache);
+    }
+    m_free(cache);
+}
+
+//
+// return the cached glyph and mark it most recently used, or NULL on a miss.
+//
+
+s3lcd_glyph_t *s3lcd_glyph_cache_find(s3lcd_glyph_cache_t *cache, mp_obj_t font, uint32_t codepoint) {
+    s3lcd_glyph_t *glyph = cache->buckets[glyph_cache_hash(font, codepoint)];
+
+    while (glyph) {
+        if (glyph->codepoint == codepoint && glyph->font == font) {
+            if (glyph != cache->head) {
+                glyph_cache_unlink(cache, glyph);
+                glyph_cache_push(cache, glyph);
+            }
+            cache->hits++;
+            return glyph;
+        }
+        glyph = glyph->chain;
+    }
+    cache->misses++;
+    return NULL;
+}
+
+//
+// add an entry for width x height pixels, evicting older entries as needed.
+// The caller fills in the pixels. Returns NULL if the glyph is larger than
+// the whole cache.
+//
+
+s3lcd_glyph_t *s3lcd_glyph_cache_add(s3lcd_glyph_cache_t *cache, mp_obj_t font, uint32_t codepoint, uint16_t width, uint16_t height) {
+    size_t bytes = sizeof(s3lcd_glyph_t) + width * height;
+    if (bytes > cache->size) {
+        return NULL;
+    }
+
+    while (cache->used + bytes > cache->size) {
+        glyph_cache_evict(cache);
+    }
+
+    s3lcd_glyph_t *glyph = m_malloc(bytes);
+    glyph->font = font;
+    glyph->codepoint = codepoint;
+    glyph->width = width;
+    glyph->height = height;
+
+    uint32_t hash = glyph_cache_hash(font, codepoint);
+    glyph->chain = cache->buckets[hash];
+    cache->buckets[hash] = glyph;
+    glyph_cache_push(cache, glyph);
+    cache->used += bytes;
+    return glyph;
+}
+
+//
+// order glyph index entries by codepoint, then by position in MAP.
+//
+
+static int glyph_index_compare(const void *a, const void *b) {
+    const s3lcd_glyph_index_t *ga = a;
+    const s3lcd_glyph_index_t *gb = b;
+    if (ga->codepoint != gb->codepoint) {
+        return (ga->codepoint > gb->codepoint) - (ga->codepoint < gb->codepoint);
+    }
+    return (ga->index > gb->index) - (ga->index < gb->index);
+}
+
+static void s3lcd_font_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    s3lcd_font_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<Font glyphs=%u, height=%u, bpp=%u>", self->count, self->height, self->bpp);
+}
+
+///
+/// s3lcd.Font(font {, height})
+/// Compile a font module created by the font2bitmap utility, or open a font
+/// file created by the font2bin utility or a TrueType font file, for use with
+/// the write() and write_len() methods. The font data of a module is resolved
+/// once and the characters in MAP are indexed for fast lookup. Glyphs in a
+/// font file are read from the file as they are used; TrueType glyphs are
+/// rasterized as 8 bit per pixel anti-aliased glyphs.
+/// required parameters:
+/// -- font: a font module or the name of a font file
+/// optional parameters:
+/// -- height: the height in pixels to rasterize a TrueType font file
+///
+
+static mp_obj_t s3lcd_font_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    mp_arg_check_num(n_args, n_kw, 1, 2, false);
+
+    s3lcd_font_obj_t *self = m_new_obj_with_finaliser(s3lcd_font_obj_t);
+    self->base.type = &s3lcd_font_type;
+
+    if (mp_obj_is_str(all_args[0])) {
+        if (n_args == 2) {
+            s3lcd_ttf_open(self, mp_obj_str_get_str(all_args[0]), mp_obj_get_int(all_args[1]));
+        } else {
+            font_file_open(self, mp_obj_str_get_str(all_args[0]));
+        }
+        return MP_OBJ_FROM_PTR(self);
+    }
+
+    if (n_args == 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("height requires a TrueType font file"));
+    }
+
+    s3lcd_font_from_module(self, all_args[0]);
+
+    size_t count = 0;
+    const byte *map_s = self->map, *map_top = self->map + self->map_len;
+    while (map_s < map_top) {
+        map_s = utf8_next_char(map_s);
+        count++;
+    }
+
+    if (count == 0 || count > UINT16_MAX) {
+        mp_raise_ValueError(MP_ERROR_TEXT("font MAP must contain 1 to 65535 characters"));
+    }
+
+    s3lcd_glyph_index_t *index = m_new(s3lcd_glyph_index_t, count);
+    map_s = self->map;
+    for (size_t i = 0; i < count; i++) {
+        index[i].codepoint = utf8_get_char(map_s);
+        index[i].index = i;
+        map_s = utf8_next_char(map_s);
+    }
+    qsort(index, count, sizeof(s3lcd_glyph_index_t), glyph_index_compare);
+
+    // a character repeated in MAP keeps its first glyph, as the module lookup does
+    size_t unique = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (index[i].codepoint != index[unique - 1].codepoint) {
+            index[unique++] = index[i];
+        }
+    }
+    count = unique;
+
+    self->count = count;
+    self->index = index;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+///
+/// .deinit()
+/// Close the font file of a Font opened from a font or TrueType file.
+///
+
+static mp_obj_t s3lcd_font_deinit(mp_obj_t self_in) {
+    s3lcd_font_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->ttf) {
+        m_free(self->ttf);
+        self->ttf = NULL;
+    }
+    if (self->file) {
+        mp_close(self->file->fp);
+        m_free(self->file->glyph);
+        m_free(self->file);
+        self->file = NULL;
+        self->count = 0;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_font_deinit_obj, s3lcd_font_deinit);
+
+//
+// finaliser: close the font file and free the buffers of a Font that is no
+// longer referenced.
+//
+
+static mp_obj_t s3lcd_font_del(mp_obj_t self_in) {
+    s3lcd_font_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    s3lcd_font_deinit(self_in);
+    if (self->index) {
+        m_free(self->index);
+        self->index = NULL;
+        self->count = 0;
+    }
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(s3lcd_font_del_obj, s3lcd_font_del);
+
+static const mp_rom_map_elem_t s3lcd_font_locals_dict_table[] = {
+    {MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&s3lcd_font_deinit_obj)},
+    {MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&s3lcd_font_del_obj)},
+};
+static MP_DEFINE_CONST_DICT(s3lcd_font_locals_dict, s3lcd_font_locals_dict_table);
+
+#if MICROPY_OBJ_TYPE_REPR == MICROPY_OBJ_TYPE_REPR_SLOT_INDEX
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    s3lcd_font_type,
+    MP_QSTR_Font,
+    MP_TYPE_FLAG_NONE,
+    print, s3lcd_font_print,
+    make_new, s3lcd_font_make_new,
+    locals_dict, &s3lcd_font_locals_dict);
+
+#else
+
+const mp_obj_type_t s3lcd_font_type = {
+    {&mp_type_type},
+    .name = MP_QSTR_Font,
+    .print = s3lcd_font_print,
+    .make_new = s3lcd_font_make_new,
+    .locals_dict = (mp_obj_dict_t *)&s3lcd_font_locals_dict,
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __s3lcd_font_H__
+#define __s3lcd_font_H__
+
+#include "py/obj.h"
+#include "mpfile.h"
+
+typedef struct _bitstream_t {
+    const uint8_t *data;    // packed pixel data
+    uint32_t bit;           // current bit position in data
+} bitstream_t;
+
+// Glyph index entry, sorted by codepoint
+
+typedef struct _s3lcd_glyph_index_t {
+    uint32_t codepoint;                     // unicode codepoint
+    uint16_t index;                         // glyph index in WIDTHS and OFFSETS
+} s3lcd_glyph_index_t;
+
+// Binary font file header, see utils/font2bin.py
+
+#define FONT_FILE_MAGIC "S3LF"
+#define FONT_FILE_VERSION 1
+#define FONT_FILE_HEADER_SIZE 16
+
+// Binary font file read cache
+
+#define FONT_BLOCK_SIZE 256
+#define FONT_BLOCKS 4
+
+typedef struct _s3lcd_font_block_t {
+    uint32_t pos;                           // file position of data or UINT32_MAX if empty
+    uint32_t used;                          // access counter value when last used
+    uint16_t len;                           // bytes of data read
+    uint8_t data[FONT_BLOCK_SIZE];
+} s3lcd_font_block_t;
+
+typedef struct _s3lcd_font_file_t {
+    mp_file_t *fp;                          // open font file
+    uint32_t codepoints_pos;                // file position of sorted codepoints
+    uint32_t widths_pos;                    // file position of glyph widths
+    uint32_t offsets_pos;                   // file position of glyph bit offsets
+    uint32_t bitmaps_pos;                   // file position of packed glyph bitmaps
+    uint32_t used;                          // block access counter
+    int glyph_index;                        // index of the last glyph read or -1
+    uint8_t *glyph;                         // bitmap of the last glyph read
+    size_t glyph_size;                      // size of glyph buffer in bytes
+    s3lcd_font_block_t blocks[FONT_BLOCKS];
+} s3lcd_font_file_t;
+
+// Compiled proportional bitmap font
+
+typedef struct _s3lcd_font_obj_t {
+    mp_obj_base_t base;                     // base class
+    mp_obj_t module;                        // font module keeping the font buffers alive, or the
+                                            // Font itself for font files; also the glyph cache key
+    uint8_t bpp;                            // bits per pixel
+    uint8_t height;                         // glyph height in pixels
+    uint8_t offset_width;                   // bytes per OFFSETS entry
+    uint8_t spread;                         // distance field spread in pixels, 0 for bitmap fonts
+    const uint8_t *widths;                  // glyph widths
+    const uint8_t *offsets;                 // glyph bit offsets into bitmaps
+    const uint8_t *bitmaps;                 // packed glyph bitmaps
+    const byte *map;                        // MAP string, used when index is NULL
+    size_t map_len;                         // MAP string length in bytes
+    uint16_t count;                         // number of glyphs in index
+    s3lcd_glyph_index_t *index;             // glyph index sorted by codepoint or NULL
+    s3lcd_font_file_t *file;                // glyphs read on demand from a font file or NULL
+    struct _s3lcd_ttf_t *ttf;               // glyphs rasterized from a TrueType file or NULL
+} s3lcd_font_obj_t;
+
+// Decoded glyph cache entry
+
+typedef struct _s3lcd_glyph_t {
+    struct _s3lcd_glyph_t *prev;            // previous entry in lru list, more recently used
+    struct _s3lcd_glyph_t *next;            // next entry in lru list, less recently used
+    struct _s3lcd_glyph_t *chain;           // next entry in hash bucket
+    mp_obj_t font;                          // font module the glyph was decoded from
+    uint32_t codepoint;                     // unicode codepoint
+    uint16_t width;                         // glyph width in pixels
+    uint16_t height;                        // glyph height in pixels
+    uint8_t pixels[];                       // one pixel index per byte, row major
+} s3lcd_glyph_t;
+
+#define GLYPH_CACHE_BUCKETS 64
+
+// Decoded glyph cache, bounded in bytes with least recently used eviction
+
+typedef struct _s3lcd_glyph_cache_t {
+    size_t size;                            // maximum bytes used by entries
+    size_t used;                            // bytes used by entries
+    uint32_t hits;                          // lookups found in the cache
+    uint32_t misses;                        // lookups that had to decode the glyph
+    s3lcd_glyph_t *head;                    // most recently used entry
+    s3lcd_glyph_t *tail;                    // least recently used entry
+    s3lcd_glyph_t *buckets[GLYPH_CACHE_BUCKETS];
+} s3lcd_glyph_cache_t;
+
+extern const mp_obj_type_t s3lcd_font_type;
+
+void s3lcd_font_from_module(s3lcd_font_obj_t *font, mp_obj_t module);
+s3lcd_font_obj_t *s3lcd_font_get(mp_obj_t font_in, s3lcd_font_obj_t *font_buf);
+int s3lcd_font_glyph(const s3lcd_font_obj_t *font, unichar ch);
+uint8_t s3lcd_font_width(const s3lcd_font_obj_t *font, int char_index);
+uint8_t s3lcd_font_box(const s3lcd_font_obj_t *font, int char_index, int *left);
+void s3lcd_font_bitmap(const s3lcd_font_obj_t *font, int char_index, bitstream_t *bs);
+s3lcd_font_file_t *s3lcd_font_file_new(const char *filename);
+void s3lcd_font_file_read(s3lcd_font_file_t *file, uint32_t pos, uint8_t *dst, size_t len);
+
+s3lcd_glyph_cache_t *s3lcd_glyph_cache_new(size_t size);
+void s3lcd_glyph_cache_free(s3lcd_glyph_cache_t *cache);
+s3lcd_glyph_t *s3lcd_glyph_cache_find(s3lcd_glyph_cache_t *cache, mp_obj_t font, uint32_t codepoint);
+s3lcd_glyph_t *s3lcd_glyph_cache_add(s3lcd_glyph_cache_t *cache, mp_obj_t font, uint32_t codepoint, uint16_t width, uint16_t height);
+
+#endif /* __s3lcd_font_H__ */
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include "s3lcd_hershey.h"
+
+//
+// scale a Hershey coordinate to pixels.
+//
+
+int16_t s3lcd_hershey_scale(mp_float_t scale, int8_t value) {
+    return (int)(scale * (value - 0x52) + MICROPY_FLOAT_CONST(0.5));
+}
+
+//
+// return the pen advance in pixels of a glyph at scale, bounds points at the
+// glyph's left and right coordinates. draw() and draw_len() both use it so
+// the measured width matches the drawn one.
+//
+
+int16_t s3lcd_hershey_width(const int8_t *bounds, mp_float_t scale) {
+    return s3lcd_hershey_scale(scale, bounds[1]) - s3lcd_hershey_scale(scale, bounds[0]);
+}
+
+//
+// convert every glyph in the font module to vertices at scale and angle
+//
+
+static void hershey_prescale(s3lcd_hershey_obj_t *self) {
+    mp_obj_module_t *hershey = MP_OBJ_TO_PTR(self->module);
+    mp_obj_dict_t *dict = MP_OBJ_TO_PTR(hershey->globals);
+    mp_buffer_info_t bufinfo;
+
+    mp_get_buffer_raise(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_INDEX)), &bufinfo, MP_BUFFER_READ);
+    const uint8_t *index = bufinfo.buf;
+    if (bufinfo.len < HERSHEY_CHARS * 2) {
+        mp_raise_ValueError(MP_ERROR_TEXT("Hershey font INDEX is too short"));
+    }
+
+    mp_get_buffer_raise(mp_obj_dict_get(dict, MP_OBJ_NEW_QSTR(MP_QSTR_FONT)), &bufinfo, MP_BUFFER_READ);
+    const int8_t *font = bufinfo.buf;
+
+    // one vertex per coordinate pair, pen up markers included
+    size_t total = 0;
+    for (int c = 0; c < HERSHEY_CHARS; c++) {
+        uint16_t offset = index[c * 2] | (index[c * 2 + 1] << 8);
+        total += font[offset];
+    }
+    if (total > UINT16_MAX) {
+        mp_raise_ValueError(MP_ERROR_TEXT("Hershey font is too large"));
+    }
+
+    int16_t *vertices = m_new(int16_t, total * 2 + 1);
+    mp_float_t cos_angle = MICROPY_FLOAT_C_FUN(cos)(self->angle);
+    mp_float_t sin_angle = MICROPY_FLOAT_C_FUN(sin)(self->angle);
+    bool rotate = (self->angle != 0);
+    size_t v = 0;
+
+    for (int c = 0; c < HERSHEY_CHARS; c++) {
+        s3lcd_hershey_glyph_t *glyph = &self->glyphs[c];
+        uint16_t offset = index[c * 2] | (index[c * 2 + 1] << 8);
+        int16_t length = font[offset++];
+        int16_t left = s3lcd_hershey_scale(self->scale, font[offset]);
+
+        glyph->start = v;
+        glyph->count = length;
+        glyph->width = s3lcd_hershey_width(&font[offset], self->scale);
+        offset += 2;
+        glyph->advance_x = MICROPY_FLOAT_C_FUN(round)(glyph->width * cos_angle * (1 << HERSHEY_FRAC));
+        glyph->advance_y = MICROPY_FLOAT_C_FUN(round)(glyph->width * sin_angle * (1 << HERSHEY_FRAC));
+
+        for (int i = 0; i < length; i++, v++) {
+            if (font[offset] == ' ') {
+                offset += 2;
+                vertices[v * 2] = HERSHEY_PENUP;
+                vertices[v * 2 + 1] = 0;
+                continue;
+            }
+
+            int16_t x = s3lcd_hershey_scale(self->scale, font[offset++]) - left;
+            int16_t y = s3lcd_hershey_scale(self->scale, font[offset++]);
+            if (rotate) {
+                vertices[v * 2] = MICROPY_FLOAT_C_FUN(round)(x * cos_angle - y * sin_angle);
+                vertices[v * 2 + 1] = MICROPY_FLOAT_C_FUN(round)(x * sin_angle + y * cos_angle);
+            } else {
+                vertices[v * 2] = x;
+                vertices[v * 2 + 1] = y;
+            }
+        }
+    }
+    self->vertices = vertices;
+}
+
+static void s3lcd_hershey_print(const mp_print_t *print, mp_obj_t self_in, mp_print_kind_t kind) {
+    (void)kind;
+    s3lcd_hershey_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_printf(print, "<Hershey scale=%f, angle=%f>", (double)self->scale, (double)self->angle);
+}
+
+///
+/// s3lcd.Hershey(font_module {, scale, angle})
+/// Convert the glyphs of a Hershey font module to integer vertices at the
+/// given scale and rotation for use with the draw() and draw_len() methods.
+/// required parameters:
+/// -- font_module: a Hershey font module
+/// optional parameters:
+/// -- scale: scale factor, defaults to 1
+/// -- angle: rotation in radians clockwise, defaults to 0
+///
+
+static mp_obj_t s3lcd_hershey_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *all_args) {
+    enum { ARG_font, ARG_scale, ARG_angle };
+    static const mp_arg_t allowed_args[] = {
+        {MP_QSTR_font, MP_ARG_OBJ | MP_ARG_REQUIRED, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_scale, MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL}},
+        {MP_QSTR_angle, MP_ARG_OBJ, {.u_obj = MP_OBJ_NULL}},
+    };
+
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all_kw_array(n_args, n_kw, all_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+
+    if (!mp_obj_is_type(args[ARG_font].u_obj, &mp_type_module)) {
+        mp_raise_TypeError(MP_ERROR_TEXT("Hershey requires a font module"));
+    }
+
+    s3lcd_hershey_obj_t *self = m_new_obj(s3lcd_hershey_obj_t);
+    self->base.type = &s3lcd_hershey_type;
+    self->module = args[ARG_font].u_obj;
+    self->scale = (args[ARG_scale].u_obj == MP_OBJ_NULL) ? 1.0 : mp_obj_get_float(args[ARG_scale].u_obj);
+    self->angle = (args[ARG_angle].u_obj == MP_OBJ_NULL) ? 0.0 : mp_obj_get_float(args[ARG_angle].u_obj);
+    hershey_prescale(self);
+    return MP_OBJ_FROM_PTR(self);
+}
+
+static const mp_rom_map_elem_t s3lcd_hershey_locals_dict_table[] = {
+};
+static MP_DEFINE_CONST_DICT(s3lcd_hershey_locals_dict, s3lcd_hershey_locals_dict_table);
+
+#if MICROPY_OBJ_TYPE_REPR == MICROPY_OBJ_TYPE_REPR_SLOT_INDEX
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    s3lcd_hershey_type,
+    MP_QSTR_Hershey,
+    MP_TYPE_FLAG_NONE,
+    print, s3lcd_hershey_print,
+    make_new, s3lcd_hershey_make_new,
+    locals_dict, &s3lcd_hershey_locals_dict);
+
+#else
+
+const mp_obj_type_t s3lcd_hershey_type = {
+    {&mp_type_type},
+    .name = MP_QSTR_Hershey,
+    .print = s3lcd_hershey_print,
+    .make_new = s3lcd_hershey_make_new,
+    .locals_dict = (mp_obj_dict_t *)&s3lcd_hershey_locals_dict,
+};
+
+#endif
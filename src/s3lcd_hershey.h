@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#ifndef __s3lcd_hershey_H__
+#define __s3lcd_hershey_H__
+
+#include "py/obj.h"
+
+#define HERSHEY_FIRST 32                    // first character in a Hershey font module
+#define HERSHEY_CHARS 96                    // number of characters in a Hershey font module
+#define HERSHEY_PENUP INT16_MIN             // vertex x value that lifts the pen
+#define HERSHEY_FRAC 8                      // fraction bits of advances
+
+// Prescaled Hershey glyph
+
+typedef struct _s3lcd_hershey_glyph_t {
+    uint16_t start;                         // index of the first vertex
+    uint16_t count;                         // number of vertices including pen up markers
+    int16_t width;                          // scaled width in pixels
+    int32_t advance_x;                      // rotated pen advance in 1/256 pixels
+    int32_t advance_y;
+} s3lcd_hershey_glyph_t;
+
+// Hershey font prescaled to integer vertices at one scale and angle
+
+typedef struct _s3lcd_hershey_obj_t {
+    mp_obj_base_t base;                     // base class
+    mp_obj_t module;                        // Hershey font module
+    mp_float_t scale;                       // scale factor
+    mp_float_t angle;                       // rotation in radians
+    s3lcd_hershey_glyph_t glyphs[HERSHEY_CHARS];
+    int16_t *vertices;                      // x, y pairs relative to the glyph origin
+} s3lcd_hershey_obj_t;
+
+extern const mp_obj_type_t s3lcd_hershey_type;
+
+int16_t s3lcd_hershey_scale(mp_float_t scale, int8_t value);
+int16_t s3lcd_hershey_width(const int8_t *bounds, mp_float_t scale);
+
+#endif /* __s3lcd_hershey_H__ */
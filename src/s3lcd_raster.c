@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <math.h>
+
+#include "s3lcd_raster.h"
+
+static inline float clampf(float v, float lo, float hi) {
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+//
+// add the area of a line inside the raster to the cells it crosses
+//
+
+static void raster_cells(s3lcd_raster_t *r, float x0, float y0, float x1, float y1) {
+    x0 = clampf(x0, 0, r->width);
+    x1 = clampf(x1, 0, r->width);
+    y0 = clampf(y0, 0, r->height);
+    y1 = clampf(y1, 0, r->height);
+    if (y0 == y1) {
+        return;
+    }
+
+    float dir = 1.0f;
+    if (y0 > y1) {
+        float t = x0;
+        x0 = x1;
+        x1 = t;
+        t = y0;
+        y0 = y1;
+        y1 = t;
+        dir = -1.0f;
+    }
+
+    float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0;
+    int y_end = (int)ceilf(y1);
+
+    for (int y = (int)y0; y < y_end; y++) {
+        float *row = r->area + y * r->stride;
+        float dy = fminf(y + 1, y1) - fmaxf(y, y0);
+        float x_next = clampf(x + dxdy * dy, 0, r->width);
+        float d = dy * dir;
+        float xa = fminf(x, x_next);
+        float xb = fmaxf(x, x_next);
+        float xa_floor = floorf(xa);
+        float xb_ceil = ceilf(xb);
+        int xai = (int)xa_floor;
+        int xbi = (int)xb_ceil;
+
+        if (xbi <= xai + 1) {
+            // the line stays within one column of this row
+            float xm = 0.5f * (x + x_next) - xa_floor;
+            row[xai] += d - d * xm;
+            row[xai + 1] += d * xm;
+        } else {
+            // spread the area over the columns the line crosses
+            float s = 1.0f / (xb - xa);
+            float xaf = xa - xa_floor;
+            float a0 = 0.5f * s * (1.0f - xaf) * (1.0f - xaf);
+            float xbf = xb - xb_ceil + 1.0f;
+            float am = 0.5f * s * xbf * xbf;
+
+            row[xai] += d * a0;
+            if (xbi == xai + 2) {
+                row[xai + 1] += d * (1.0f - a0 - am);
+            } else {
+                float a1 = s * (1.5f - xaf);
+                row[xai + 1] += d * (a1 - a0);
+                for (int xi = xai + 2; xi < xbi - 1; xi++) {
+                    row[xi] += d * s;
+                }
+                float a2 = a1 + (xbi - xai - 3) * s;
+                row[xbi - 1] += d * (1.0f - a2 - am);
+            }
+            row[xbi] += d * am;
+        }
+        x = x_next;
+    }
+}
+
+//
+// s3lcd_raster_line: add a line to the raster. The line is clipped to the
+// rows of the raster, parts of it left of the raster are added as a vertical
+// line on the left edge and parts of it right of the raster are dropped.
+//
+
+void s3lcd_raster_line(s3lcd_raster_t *r, float x0, float y0, float x1, float y1) {
+    float w = r->width;
+    float h = r->height;
+
+    if (y0 == y1 || (y0 <= 0 && y1 <= 0) || (y0 >= h && y1 >= h)) {
+        return;
+    }
+
+    float dxdy = (x1 - x0) / (y1 - y0);
+    if (y0 < 0 || y0 > h) {
+        float y = (y0 < 0) ? 0 : h;
+        x0 += (y - y0) * dxdy;
+        y0 = y;
+    }
+    if (y1 < 0 || y1 > h) {
+        float y = (y1 < 0) ? 0 : h;
+        x1 += (y - y1) * dxdy;
+        y1 = y;
+    }
+
+    if (x0 >= w && x1 >= w) {
+        return;
+    }
+    if (x0 <= 0 && x1 <= 0) {
+        raster_cells(r, 0, y0, 0, y1);
+        return;
+    }
+
+    float dydx = (y1 - y0) / (x1 - x0);
+    if (x0 < 0 || x1 < 0) {
+        float y = y0 - x0 * dydx;
+        if (x0 < 0) {
+            raster_cells(r, 0, y0, 0, y);
+            x0 = 0;
+            y0 = y;
+        } else {
+            raster_cells(r, 0, y, 0, y1);
+            x1 = 0;
+            y1 = y;
+        }
+    }
+    if (x0 > w) {
+        y0 += (w - x0) * dydx;
+        x0 = w;
+    } else if (x1 > w) {
+        y1 += (w - x1) * dydx;
+        x1 = w;
+    }
+
+    raster_cells(r, x0, y0, x1, y1);
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __s3lcd_raster_H__
+#define __s3lcd_raster_H__
+
+//
+// Coverage rasterizer
+//
+// Each line of an outline adds the signed area it covers to the cells it
+// crosses, and the running sum of each row is the pixel's coverage. Rows
+// have two extra cells for the area to the right of lines on the last column.
+//
+
+typedef struct _s3lcd_raster_t {
+    float *area;                            // signed area of each cell
+    int width;                              // width in pixels
+    int height;                             // height in pixels
+    int stride;                             // cells per row, width + 2
+} s3lcd_raster_t;
+
+void s3lcd_raster_line(s3lcd_raster_t *r, float x0, float y0, float x1, float y1);
+
+#endif /* __s3lcd_raster_H__ */
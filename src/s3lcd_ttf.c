@@ -0,0 +1,592 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+#include <math.h>
+#include <string.h>
+
+#include "py/obj.h"
+#include "py/runtime.h"
+
+#include "s3lcd_raster.h"
+#include "s3lcd_ttf.h"
+
+//
+// TrueType fonts
+//
+// Glyph outlines are read from a TrueType font file as they are drawn and
+// rasterized with anti-aliasing into an 8 bit per pixel glyph the width of
+// the outline's bounding box and the height of the font, placed at its left
+// side bearing from the pen position. Table lookups go
+// through the font file block cache; each glyph's outline is read directly.
+// Only quadratic TrueType outlines are supported, CFF based OpenType fonts
+// are not. Components of composite glyphs are placed at their offsets,
+// component scaling is ignored.
+//
+
+#define TAG(a, b, c, d) ((uint32_t)(a) << 24 | (uint32_t)(b) << 16 | (uint32_t)(c) << 8 | (uint32_t)(d))
+
+// composite glyph component flags
+
+#define ARG_1_AND_2_ARE_WORDS 0x0001
+#define ARGS_ARE_XY_VALUES 0x0002
+#define WE_HAVE_A_SCALE 0x0008
+#define MORE_COMPONENTS 0x0020
+#define WE_HAVE_AN_X_AND_Y_SCALE 0x0040
+#define WE_HAVE_A_TWO_BY_TWO 0x0080
+
+// simple glyph point flags
+
+#define ON_CURVE_POINT 0x01
+#define X_SHORT_VECTOR 0x02
+#define Y_SHORT_VECTOR 0x04
+#define REPEAT_FLAG 0x08
+#define X_IS_SAME_OR_POSITIVE 0x10
+#define Y_IS_SAME_OR_POSITIVE 0x20
+
+static uint16_t ttf_u16(s3lcd_font_file_t *file, uint32_t pos) {
+    uint8_t b[2];
+    s3lcd_font_file_read(file, pos, b, 2);
+    return b[0] << 8 | b[1];
+}
+
+static uint32_t ttf_u32(s3lcd_font_file_t *file, uint32_t pos) {
+    uint8_t b[4];
+    s3lcd_font_file_read(file, pos, b, 4);
+    return (uint32_t)b[0] << 24 | b[1] << 16 | b[2] << 8 | b[3];
+}
+
+//
+// Glyphs are rasterized with the shared coverage rasterizer, scaled from
+// font units to pixels with the y axis flipped at the baseline.
+//
+
+typedef struct _ttf_raster_t {
+    s3lcd_raster_t cells;                   // coverage cells of the glyph
+    mp_float_t scale;                       // pixels per font unit
+    mp_float_t baseline;                    // baseline in pixels from the top
+    mp_float_t left;                        // pen position in pixels of the first column
+} ttf_raster_t;
+
+//
+// add a quadratic curve as lines, using more lines for sharper curves.
+//
+
+static void raster_quad(ttf_raster_t *r, mp_float_t x0, mp_float_t y0, mp_float_t cx, mp_float_t cy, mp_float_t x1, mp_float_t y1) {
+    mp_float_t dd = MICROPY_FLOAT_C_FUN(fabs)(x0 - 2 * cx + x1) + MICROPY_FLOAT_C_FUN(fabs)(y0 - 2 * cy + y1);
+    int steps = 1 + (int)MICROPY_FLOAT_C_FUN(sqrt)(dd);
+    if (steps > TTF_MAX_CURVE_STEPS) {
+        steps = TTF_MAX_CURVE_STEPS;
+    }
+
+    mp_float_t px = x0, py = y0;
+    for (int i = 1; i <= steps; i++) {
+        mp_float_t t = (mp_float_t)i / steps;
+        mp_float_t mt = MICROPY_FLOAT_CONST(1.0) - t;
+        mp_float_t x = mt * mt * x0 + 2 * mt * t * cx + t * t * x1;
+        mp_float_t y = mt * mt * y0 + 2 * mt * t * cy + t * t * y1;
+        s3lcd_raster_line(&r->cells, px, py, x, y);
+        px = x;
+        py = y;
+    }
+}
+
+//
+// Glyph outlines
+//
+
+static void glyph_check(size_t pos, size_t len) {
+    if (pos > len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("TrueType glyph is corrupt"));
+    }
+}
+
+static inline uint16_t be16(const uint8_t *p) {
+    return p[0] << 8 | p[1];
+}
+
+//
+// add the contours of a simple glyph, offset by dx, dy font units.
+//
+
+static void glyph_simple(ttf_raster_t *r, const uint8_t *data, size_t len, int contours, int dx, int dy) {
+    size_t pos = 10;
+    glyph_check(pos + contours * 2 + 2, len);
+    const uint8_t *end_points = data + pos;
+    int points = be16(end_points + (contours - 1) * 2) + 1;
+    pos += contours * 2;
+    pos += 2 + be16(data + pos);
+
+    uint8_t *flags = m_new(uint8_t, points);
+    mp_float_t *xs = m_new(mp_float_t, points);
+    mp_float_t *ys = m_new(mp_float_t, points);
+
+    for (int i = 0; i < points;) {
+        glyph_check(pos + 1, len);
+        uint8_t flag = data[pos++];
+        int repeat = 0;
+        if (flag & REPEAT_FLAG) {
+            glyph_check(pos + 1, len);
+            repeat = data[pos++];
+        }
+        for (int n = 0; n <= repeat && i < points; n++) {
+            flags[i++] = flag;
+        }
+    }
+
+    int v = 0;
+    for (int i = 0; i < points; i++) {
+        if (flags[i] & X_SHORT_VECTOR) {
+            glyph_check(pos + 1, len);
+            v += (flags[i] & X_IS_SAME_OR_POSITIVE) ? data[pos] : -data[pos];
+            pos++;
+        } else if (!(flags[i] & X_IS_SAME_OR_POSITIVE)) {
+            glyph_check(pos + 2, len);
+            v += (int16_t)be16(data + pos);
+            pos += 2;
+        }
+        xs[i] = (v + dx) * r->scale - r->left;
+    }
+
+    v = 0;
+    for (int i = 0; i < points; i++) {
+        if (flags[i] & Y_SHORT_VECTOR) {
+            glyph_check(pos + 1, len);
+            v += (flags[i] & Y_IS_SAME_OR_POSITIVE) ? data[pos] : -data[pos];
+            pos++;
+        } else if (!(flags[i] & Y_IS_SAME_OR_POSITIVE)) {
+            glyph_check(pos + 2, len);
+            v += (int16_t)be16(data + pos);
+            pos += 2;
+        }
+        ys[i] = r->baseline - (v + dy) * r->scale;
+    }
+
+    int first = 0;
+    for (int c = 0; c < contours; c++) {
+        int last = be16(end_points + c * 2);
+        if (last >= points || last < first) {
+            break;
+        }
+
+        // start on an on curve point, or between two off curve points
+        mp_float_t sx, sy;
+        int i = first, stop = last;
+        if (flags[first] & ON_CURVE_POINT) {
+            sx = xs[first];
+            sy = ys[first];
+            i++;
+        } else if (flags[last] & ON_CURVE_POINT) {
+            sx = xs[last];
+            sy = ys[last];
+            stop--;
+        } else {
+            sx = (xs[first] + xs[last]) / 2;
+            sy = (ys[first] + ys[last]) / 2;
+        }
+
+        mp_float_t px = sx, py = sy, cx = 0, cy = 0;
+        bool control = false;
+        for (; i <= stop + 1; i++) {
+            // the last step closes the contour back to the start point
+            bool on = (i > stop) || (flags[i] & ON_CURVE_POINT);
+            mp_float_t x = (i > stop) ? sx : xs[i];
+            mp_float_t y = (i > stop) ? sy : ys[i];
+
+            if (on) {
+                if (control) {
+                    raster_quad(r, px, py, cx, cy, x, y);
+                } else {
+                    s3lcd_raster_line(&r->cells, px, py, x, y);
+                }
+                px = x;
+                py = y;
+                control = false;
+            } else {
+                if (control) {
+                    mp_float_t mx = (cx + x) / 2;
+                    mp_float_t my = (cy + y) / 2;
+                    raster_quad(r, px, py, cx, cy, mx, my);
+                    px = mx;
+                    py = my;
+                }
+                cx = x;
+                cy = y;
+                control = true;
+            }
+        }
+        first = last + 1;
+    }
+
+    m_free(ys);
+    m_free(xs);
+    m_free(flags);
+}
+
+//
+// find the glyf table data of glyph, returns false if glyph has no outline.
+//
+
+static bool glyph_location(const s3lcd_font_obj_t *font, int glyph, uint32_t *start, uint32_t *end) {
+    s3lcd_font_file_t *file = font->file;
+    s3lcd_ttf_t *ttf = font->ttf;
+
+    if (glyph >= ttf->num_glyphs) {
+        return false;
+    }
+    if (ttf->loca_long) {
+        *start = ttf_u32(file, ttf->loca_pos + glyph * 4);
+        *end = ttf_u32(file, ttf->loca_pos + glyph * 4 + 4);
+    } else {
+        *start = ttf_u16(file, ttf->loca_pos + glyph * 2) * 2;
+        *end = ttf_u16(file, ttf->loca_pos + glyph * 2 + 2) * 2;
+    }
+    return *end > *start + 10;
+}
+
+//
+// add the outline of glyph to the raster, offset by dx, dy font units.
+//
+
+static void glyph_outline(const s3lcd_font_obj_t *font, ttf_raster_t *r, int glyph, int dx, int dy, int depth) {
+    s3lcd_font_file_t *file = font->file;
+    s3lcd_ttf_t *ttf = font->ttf;
+
+    uint32_t start, end;
+    if (depth > TTF_MAX_DEPTH || !glyph_location(font, glyph, &start, &end)) {
+        return;
+    }
+
+    size_t len = end - start;
+    uint8_t *data = m_new(uint8_t, len);
+    mp_seek(file->fp, ttf->glyf_pos + start, MP_SEEK_SET);
+    if ((size_t)mp_readinto(file->fp, data, len) != len) {
+        mp_raise_ValueError(MP_ERROR_TEXT("font file is truncated"));
+    }
+
+    int contours = (int16_t)be16(data);
+    if (contours > 0) {
+        glyph_simple(r, data, len, contours, dx, dy);
+    } else if (contours < 0) {
+        size_t pos = 10;
+        uint16_t flags;
+        do {
+            glyph_check(pos + 4, len);
+            flags = be16(data + pos);
+            uint16_t component = be16(data + pos + 2);
+            pos += 4;
+
+            int arg1, arg2;
+            if (flags & ARG_1_AND_2_ARE_WORDS) {
+                glyph_check(pos + 4, len);
+                arg1 = (int16_t)be16(data + pos);
+                arg2 = (int16_t)be16(data + pos + 2);
+                pos += 4;
+            } else {
+                glyph_check(pos + 2, len);
+                arg1 = (int8_t)data[pos];
+                arg2 = (int8_t)data[pos + 1];
+                pos += 2;
+            }
+
+            if (flags & WE_HAVE_A_SCALE) {
+                pos += 2;
+            } else if (flags & WE_HAVE_AN_X_AND_Y_SCALE) {
+                pos += 4;
+            } else if (flags & WE_HAVE_A_TWO_BY_TWO) {
+                pos += 8;
+            }
+
+            // components positioned by matching points are drawn unmoved
+            if (flags & ARGS_ARE_XY_VALUES) {
+                glyph_outline(font, r, component, dx + arg1, dy + arg2, depth + 1);
+            } else {
+                glyph_outline(font, r, component, dx, dy, depth + 1);
+            }
+        } while (flags & MORE_COMPONENTS);
+    }
+
+    m_free(data);
+}
+
+//
+// open a TrueType font file, read its table positions and metrics and size
+// the glyphs to height pixels from the top of the ascender to the bottom of
+// the descender.
+//
+
+void s3lcd_ttf_open(s3lcd_font_obj_t *font, const char *filename, int height) {
+    if (height < 1 || height > 255) {
+        mp_raise_ValueError(MP_ERROR_TEXT("height must be 1 to 255"));
+    }
+
+    s3lcd_font_file_t *file = s3lcd_font_file_new(filename);
+    uint32_t version = ttf_u32(file, 0);
+    if (version != 0x00010000 && version != TAG('t', 'r', 'u', 'e')) {
+        mp_close(file->fp);
+        mp_raise_ValueError(MP_ERROR_TEXT("not a TrueType font file"));
+    }
+
+    uint32_t cmap = 0, head = 0, hhea = 0, maxp = 0, loca = 0, glyf = 0, hmtx = 0;
+    uint16_t tables = ttf_u16(file, 4);
+    for (int i = 0; i < tables; i++) {
+        uint32_t record = 12 + i * 16;
+        uint32_t offset = ttf_u32(file, record + 8);
+        switch (ttf_u32(file, record)) {
+            case TAG('c', 'm', 'a', 'p'):
+                cmap = offset;
+                break;
+            case TAG('h', 'e', 'a', 'd'):
+                head = offset;
+                break;
+            case TAG('h', 'h', 'e', 'a'):
+                hhea = offset;
+                break;
+            case TAG('m', 'a', 'x', 'p'):
+                maxp = offset;
+                break;
+            case TAG('l', 'o', 'c', 'a'):
+                loca = offset;
+                break;
+            case TAG('g', 'l', 'y', 'f'):
+                glyf = offset;
+                break;
+            case TAG('h', 'm', 't', 'x'):
+                hmtx = offset;
+                break;
+        }
+    }
+
+    if (!cmap || !head || !hhea || !maxp || !loca || !glyf || !hmtx) {
+        mp_close(file->fp);
+        mp_raise_ValueError(MP_ERROR_TEXT("TrueType font is missing tables"));
+    }
+
+    // prefer the full unicode character map to the basic multilingual plane
+    uint32_t cmap_pos = 0;
+    uint16_t cmap_format = 0;
+    uint16_t subtables = ttf_u16(file, cmap + 2);
+    for (int i = 0; i < subtables; i++) {
+        uint32_t record = cmap + 4 + i * 8;
+        uint16_t platform = ttf_u16(file, record);
+        uint16_t encoding = ttf_u16(file, record + 2);
+        uint32_t pos = cmap + ttf_u32(file, record + 4);
+        uint16_t format = ttf_u16(file, pos);
+        bool unicode = platform == 0 || (platform == 3 && (encoding == 1 || encoding == 10));
+
+        if (unicode && format == 12) {
+            cmap_pos = pos;
+            cmap_format = 12;
+            break;
+        }
+        if (unicode && format == 4 && cmap_format == 0) {
+            cmap_pos = pos;
+            cmap_format = 4;
+        }
+    }
+
+    int ascender = (int16_t)ttf_u16(file, hhea + 4);
+    int descender = (int16_t)ttf_u16(file, hhea + 6);
+    if (cmap_format == 0 || ascender <= descender) {
+        mp_close(file->fp);
+        mp_raise_ValueError(MP_ERROR_TEXT("unsupported TrueType font"));
+    }
+
+    s3lcd_ttf_t *ttf = m_new_obj(s3lcd_ttf_t);
+    ttf->cmap_pos = cmap_pos;
+    ttf->cmap_format = cmap_format;
+    ttf->loca_pos = loca;
+    ttf->glyf_pos = glyf;
+    ttf->hmtx_pos = hmtx;
+    ttf->num_hmetrics = ttf_u16(file, hhea + 34);
+    ttf->num_glyphs = ttf_u16(file, maxp + 4);
+    ttf->loca_long = ttf_u16(file, head + 50) != 0;
+    ttf->scale = (mp_float_t)height / (ascender - descender);
+    ttf->baseline = ascender * ttf->scale;
+
+    // glyph bitmaps are as wide as the widest advance or outline, plus a
+    // pixel on each side for rounding the outline out to whole pixels
+    int advance_max = ttf_u16(file, hhea + 10);
+    int extent_max = (int16_t)ttf_u16(file, hhea + 16) - (int16_t)ttf_u16(file, hhea + 12);
+    int max_width = (int)(((advance_max > extent_max) ? advance_max : extent_max) * ttf->scale) + 2;
+    if (max_width < 1) {
+        max_width = 1;
+    } else if (max_width > 255) {
+        max_width = 255;
+    }
+    file->glyph_size = max_width * height;
+    file->glyph = m_new(uint8_t, file->glyph_size);
+
+    font->module = MP_OBJ_FROM_PTR(font);
+    font->bpp = 8;
+    font->height = height;
+    font->offset_width = 0;
+    font->spread = 0;
+    font->widths = NULL;
+    font->offsets = NULL;
+    font->bitmaps = NULL;
+    font->map = NULL;
+    font->map_len = 0;
+    font->count = ttf->num_glyphs;
+    font->index = NULL;
+    font->file = file;
+    font->ttf = ttf;
+}
+
+//
+// return the glyph of ch or -1 if the font does not contain it.
+//
+
+int s3lcd_ttf_glyph(const s3lcd_font_obj_t *font, unichar ch) {
+    s3lcd_font_file_t *file = font->file;
+    uint32_t pos = font->ttf->cmap_pos;
+    uint32_t glyph = 0;
+
+    if (font->ttf->cmap_format == 12) {
+        int lo = 0;
+        int hi = (int)ttf_u32(file, pos + 12) - 1;
+        while (lo <= hi) {
+            int mid = (lo + hi) / 2;
+            uint32_t group = pos + 16 + mid * 12;
+            if (ch < ttf_u32(file, group)) {
+                hi = mid - 1;
+            } else if (ch > ttf_u32(file, group + 4)) {
+                lo = mid + 1;
+            } else {
+                glyph = ttf_u32(file, group + 8) + ch - ttf_u32(file, group);
+                break;
+            }
+        }
+    } else if (ch <= 0xffff) {
+        // find the first segment ending at or after ch
+        uint16_t seg_x2 = ttf_u16(file, pos + 6);
+        uint32_t ends = pos + 14;
+        uint32_t starts = ends + seg_x2 + 2;
+        uint32_t deltas = starts + seg_x2;
+        uint32_t range_offsets = deltas + seg_x2;
+        int lo = 0;
+        int hi = seg_x2 / 2 - 1;
+        while (lo < hi) {
+            int mid = (lo + hi) / 2;
+            if (ttf_u16(file, ends + mid * 2) < ch) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        uint16_t start = ttf_u16(file, starts + lo * 2);
+        if (hi >= 0 && start <= ch && ttf_u16(file, ends + lo * 2) >= ch) {
+            uint16_t delta = ttf_u16(file, deltas + lo * 2);
+            uint32_t range_offset_pos = range_offsets + lo * 2;
+            uint16_t range_offset = ttf_u16(file, range_offset_pos);
+            if (range_offset == 0) {
+                glyph = (ch + delta) & 0xffff;
+            } else {
+                glyph = ttf_u16(file, range_offset_pos + range_offset + (ch - start) * 2);
+                if (glyph) {
+                    glyph = (glyph + delta) & 0xffff;
+                }
+            }
+        }
+    }
+
+    return (glyph == 0 || glyph >= font->ttf->num_glyphs) ? -1 : (int)glyph;
+}
+
+//
+// return the advance width in pixels of glyph.
+//
+
+uint8_t s3lcd_ttf_width(const s3lcd_font_obj_t *font, int glyph) {
+    s3lcd_ttf_t *ttf = font->ttf;
+    int metric = (glyph < ttf->num_hmetrics) ? glyph : ttf->num_hmetrics - 1;
+    int width = (int)(ttf_u16(font->file, ttf->hmtx_pos + metric * 4) * ttf->scale + MICROPY_FLOAT_CONST(0.5));
+    int max_width = font->file->glyph_size / font->height;
+    return (width > max_width) ? max_width : width;
+}
+
+//
+// return the width in pixels of the bitmap of glyph, the glyf header's
+// bounding box rounded out to whole pixels, and set left to the offset of its
+// first column from the pen position.
+//
+
+uint8_t s3lcd_ttf_box(const s3lcd_font_obj_t *font, int glyph, int *left) {
+    s3lcd_ttf_t *ttf = font->ttf;
+    uint32_t start, end;
+    *left = 0;
+    if (!glyph_location(font, glyph, &start, &end)) {
+        return 0;
+    }
+
+    int x_min = (int16_t)ttf_u16(font->file, ttf->glyf_pos + start + 2);
+    int x_max = (int16_t)ttf_u16(font->file, ttf->glyf_pos + start + 6);
+    int x0 = (int)MICROPY_FLOAT_C_FUN(floor)(x_min * ttf->scale);
+    int x1 = (int)MICROPY_FLOAT_C_FUN(ceil)(x_max * ttf->scale);
+    int max_width = font->file->glyph_size / font->height;
+    *left = x0;
+    return (x1 <= x0) ? 0 : (x1 - x0 > max_width) ? max_width : x1 - x0;
+}
+
+//
+// rasterize glyph into the font file's glyph buffer, one byte of coverage
+// per pixel over the s3lcd_ttf_box() of the glyph, and point bs at it.
+//
+
+void s3lcd_ttf_bitmap(const s3lcd_font_obj_t *font, int glyph, bitstream_t *bs) {
+    s3lcd_font_file_t *file = font->file;
+    bs->data = file->glyph;
+    bs->bit = 0;
+
+    if (glyph == file->glyph_index) {
+        return;
+    }
+    file->glyph_index = -1;
+
+    int left;
+    ttf_raster_t r;
+    r.cells.width = s3lcd_ttf_box(font, glyph, &left);
+    r.cells.height = font->height;
+    r.cells.stride = r.cells.width + 2;
+    r.cells.area = m_new(float, r.cells.stride * r.cells.height);
+    memset(r.cells.area, 0, r.cells.stride * r.cells.height * sizeof(float));
+    r.scale = font->ttf->scale;
+    r.baseline = font->ttf->baseline;
+    r.left = left;
+
+    glyph_outline(font, &r, glyph, 0, 0, 0);
+
+    uint8_t *dst = file->glyph;
+    for (int y = 0; y < r.cells.height; y++) {
+        const float *row = r.cells.area + y * r.cells.stride;
+        mp_float_t coverage = 0;
+        for (int x = 0; x < r.cells.width; x++) {
+            coverage += row[x];
+            mp_float_t c = MICROPY_FLOAT_C_FUN(fabs)(coverage);
+            *dst++ = (c >= 1) ? 255 : (uint8_t)(c * 255 + MICROPY_FLOAT_CONST(0.5));
+        }
+    }
+
+    m_free(r.cells.area);
+    file->glyph_index = glyph;
+}
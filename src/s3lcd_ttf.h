@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2023 Russ Hughes
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef __s3lcd_ttf_H__
+#define __s3lcd_ttf_H__
+
+#include "py/obj.h"
+#include "s3lcd_font.h"
+
+#define TTF_MAX_DEPTH 4                     // maximum nesting of composite glyphs
+#define TTF_MAX_CURVE_STEPS 16              // maximum lines per quadratic curve
+
+// TrueType font file tables, positions are file offsets
+
+typedef struct _s3lcd_ttf_t {
+    uint32_t cmap_pos;                      // character to glyph mapping subtable
+    uint16_t cmap_format;                   // cmap subtable format, 4 or 12
+    uint32_t loca_pos;                      // glyph locations
+    uint32_t glyf_pos;                      // glyph outlines
+    uint32_t hmtx_pos;                      // horizontal metrics
+    uint16_t num_hmetrics;                  // number of advance widths in hmtx
+    uint16_t num_glyphs;                    // number of glyphs in the font
+    bool loca_long;                         // loca entries are 32 bit offsets
+    mp_float_t scale;                       // pixels per font unit
+    mp_float_t baseline;                    // baseline in pixels from the top of the glyph
+} s3lcd_ttf_t;
+
+void s3lcd_ttf_open(s3lcd_font_obj_t *font, const char *filename, int height);
+int s3lcd_ttf_glyph(const s3lcd_font_obj_t *font, unichar ch);
+uint8_t s3lcd_ttf_width(const s3lcd_font_obj_t *font, int glyph);
+uint8_t s3lcd_ttf_box(const s3lcd_font_obj_t *font, int glyph, int *left);
+void s3lcd_ttf_bitmap(const s3lcd_font_obj_t *font, int glyph, bitstream_t *bs);
+
+#endif /* __s3lcd_ttf_H__ */
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+'''
+font2bin.py
+    Convert a proportional font module created by font2bitmap.py to a binary
+    font file for use with s3lcd.Font(). Glyphs in a font file are read from
+    flash as they are drawn, so large fonts do not need to be imported.
+
+positional arguments:
+
+  font_module           Name of the font module file to convert.
+  output_file           Name of the binary font file to create.
+
+optional arguments:
+
+  -h, --help            show this help message and exit
+
+File format, all integers are little-endian:
+
+  offset  size           contents
+  0       4              magic "S3LF"
+  4       1              version, 1
+  5       1              bits per pixel
+  6       1              height
+  7       1              maximum glyph width
+  8       4              number of glyphs
+  12      4              size of the bitmaps section in bytes
+  16      4 * glyphs     codepoints in ascending order
+          glyphs         widths, padded to a multiple of 4 bytes
+          4 * glyphs     bit offsets into the bitmaps section
+          rest           packed glyph bitmaps
+'''
+
+import argparse
+import importlib.util
+import struct
+
+MAGIC = b'S3LF'
+VERSION = 1
+
+
+def load_module(filename):
+    """Import and return the font module in filename."""
+    spec = importlib.util.spec_from_file_location('font', filename)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
+def convert(font, output_file):
+    """Write the glyphs in font module `font` to output_file."""
+    width = font.OFFSET_WIDTH
+    offsets = [
+        int.from_bytes(font.OFFSETS[i:i + width], 'big')
+        for i in range(0, len(font.OFFSETS), width)]
+
+    # write() uses the first occurrence of characters repeated in MAP
+    glyphs = {}
+    for i, char in enumerate(font.MAP):
+        glyphs.setdefault(ord(char), (ord(char), font.WIDTHS[i], offsets[i]))
+    glyphs = sorted(glyphs.values())
+
+    bitmaps = bytes(font.BITMAPS)
+    count = len(glyphs)
+
+    with open(output_file, 'wb') as out:
+        out.write(MAGIC)
+        out.write(struct.pack(
+            '<BBBBII', VERSION, font.BPP, font.HEIGHT, font.MAX_WIDTH,
+            count, len(bitmaps)))
+
+        out.write(struct.pack(f'<{count}I', *(glyph[0] for glyph in glyphs)))
+        widths = bytes(glyph[1] for glyph in glyphs)
+        out.write(widths + bytes(-len(widths) % 4))
+        out.write(struct.pack(f'<{count}I', *(glyph[2] for glyph in glyphs)))
+        out.write(bitmaps)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        prog='font2bin',
+        description=('''
+            Convert a proportional font module created by font2bitmap to a
+            binary font file for use with s3lcd.Font().'''))
+
+    parser.add_argument(
+        'font_module',
+        help='name of font module file to convert.')
+
+    parser.add_argument(
+        'output_file',
+        help='name of binary font file to create.')
+
+    args = parser.parse_args()
+    convert(load_module(args.font_module), args.output_file)
+
+
+main()
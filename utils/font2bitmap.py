@@ -96,7 +96,8 @@ class Bitmap():
     """
     A 2D bitmap image represented as a list of byte values. Each byte indicates
     the state of a single pixel in the bitmap. A value of 0 indicates that the
-    pixel is `off` and any other value indicates that it is `on`.
+    pixel is `off` and any other value indicates that it is `on`. Bitmaps
+    rendered with anti-aliasing hold the pixel's 0-255 coverage instead.
     """
     def __init__(self, width, height, pixels=None):
         self.width = int(width)
@@ -112,12 +113,21 @@ class Bitmap():
             rows += '\n'
         return rows
 
-    def bit_string(self):
-        """Return a binary string representation of the bitmap's pixels."""
+    def bit_string(self, bpp=1):
+        """
+        Return a binary string representation of the bitmap's pixels using
+        `bpp` bits per pixel. Coverage values are scaled from 0-255 to the
+        0-(2**bpp - 1) range when bpp is greater than 1.
+        """
         bits = ''
+        levels = (1 << bpp) - 1
         for y in range(self.height):
             for x in range(self.width):
-                bits += '1' if self.pixels[y * self.width + x] else '0'
+                pixel = self.pixels[y * self.width + x]
+                if bpp == 1:
+                    bits += '1' if pixel else '0'
+                else:
+                    bits += f'{(pixel * levels + 127) // 255:0{bpp}b}'
         return bits
 
     def bitblt(self, src, x, y):
@@ -128,12 +138,12 @@ class Bitmap():
 
         for _ in range(src.height):
             for _ in range(src.width):
-                # Perform an OR operation on the destination pixel and the
-                # source pixel because glyph bitmaps may overlap if character
-                # kerning is applied, e.g. in the string "AVA", the "A" and "V"
-                # glyphs must be rendered with overlapping bounding boxes.
-                self.pixels[dstpixel] = (
-                    self.pixels[dstpixel] or src.pixels[srcpixel])
+                # Keep the larger of the destination and source pixels because
+                # glyph bitmaps may overlap if character kerning is applied,
+                # e.g. in the string "AVA", the "A" and "V" glyphs must be
+                # rendered with overlapping bounding boxes.
+                self.pixels[dstpixel] = max(
+                    self.pixels[dstpixel], src.pixels[srcpixel])
                 srcpixel += 1
                 dstpixel += 1
             dstpixel += row_offset
@@ -168,7 +178,10 @@ class Glyph():
     @staticmethod
     def from_glyphslot(slot):
         """Construct and return a Glyph object from a FreeType GlyphSlot."""
-        pixels = Glyph.unpack_mono_bitmap(slot.bitmap)
+        if slot.bitmap.pixel_mode == freetype.FT_PIXEL_MODE_GRAY:
+            pixels = Glyph.unpack_gray_bitmap(slot.bitmap)
+        else:
+            pixels = Glyph.unpack_mono_bitmap(slot.bitmap)
         width, height = slot.bitmap.width, slot.bitmap.rows
         top = slot.bitmap_top
         left = slot.bitmap_left
@@ -222,17 +235,37 @@ class Glyph():
 
         return data
 
+    @staticmethod
+    def unpack_gray_bitmap(bitmap):
+        """
+        Unpack a freetype anti-aliased glyph bitmap into a bytearray where
+        each pixel is represented by its 0-255 coverage.
+        """
+        data = bytearray(bitmap.rows * bitmap.width)
+        for y in range(bitmap.rows):
+            row = y * bitmap.pitch
+            data[y * bitmap.width:(y + 1) * bitmap.width] = bytes(
+                bitmap.buffer[row:row + bitmap.width])
+
+        return data
+
 
 class Font():
-    def __init__(self, filename, width, height):
+    def __init__(self, filename, width, height, bpp=1):
         self.face = freetype.Face(filename)
         self.face.set_pixel_sizes(width, height)
+        self.bpp = bpp
 
     def glyph_for_character(self, char):
         # Let FreeType load the glyph for the given character and tell it to
-        # render a monochromatic bitmap representation.
-        self.face.load_char(
-            char, freetype.FT_LOAD_RENDER | freetype.FT_LOAD_TARGET_MONO)
+        # render a monochromatic bitmap representation, or an anti-aliased
+        # one when more than one bit per pixel was requested.
+        if self.bpp == 1:
+            target = freetype.FT_LOAD_TARGET_MONO
+        else:
+            target = freetype.FT_LOAD_TARGET_NORMAL
+
+        self.face.load_char(char, freetype.FT_LOAD_RENDER | target)
 
         return Glyph.from_glyphslot(self.face.glyph)
 
@@ -309,7 +342,7 @@ class Font():
             outbuffer.bitblt(glyph.bitmap, left, y)
 
             # convert bitmap to ascii bitmap string
-            bit_string = outbuffer.bit_string()
+            bit_string = outbuffer.bit_string(self.bpp)
             bits.append(bit_string)
             offset += len(bit_string)
 
@@ -330,7 +363,7 @@ class Font():
         print()
 
         print(f'MAP = {char_map}\n')
-        print('BPP = 1')
+        print(f'BPP = {self.bpp}')
         print(f'HEIGHT = {height}')
         print(f'MAX_WIDTH = {max_width}')
         print('_WIDTHS = \\')
@@ -379,6 +412,14 @@ def main():
         default=None,
         help='width of font to create bitmaps from.')
 
+    parser.add_argument(
+        '-b', '--bpp',
+        type=int,
+        choices=[1, 2, 4, 8],
+        default=1,
+        help='''bits per pixel, values greater than 1 create
+        anti-aliased bitmaps for use with the write method's aa option.''')
+
     group = parser.add_argument_group(
         'character selection',
         'characters from the font to include in the bitmap.')
@@ -400,7 +441,7 @@ def main():
     width = args.font_height if args.font_width is None else args.font_width
     characters = get_chars(args.characters) if args.string is None else args.string
 
-    fnt = Font(font_file, width, height)
+    fnt = Font(font_file, width, height, args.bpp)
     fnt.write_python(characters, font_file)
 
 
@@ -0,0 +1,302 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+# Needs freetype-py>=1.0
+
+'''
+font2sdf.py
+    Convert characters from a truetype font to a signed distance field font
+    module for use with the write_sdf method of the s3lcd driver. Text can be
+    drawn from a distance field font at any height with smooth edges.
+
+positional arguments:
+
+  font_file             Name of font file to convert.
+  font_height           Height in pixels of the distance fields.
+
+optional arguments:
+
+  -h, --help            show this help message and exit
+  -r SPREAD, --spread SPREAD
+                        Distance in pixels covered by the distance field
+                        outside and inside the edges of the characters,
+                        defaults to 4.
+
+character selection:
+  Characters from the font to include in the module.
+
+  -c CHARACTERS, --characters CHARACTERS
+                        integer or hex character values and/or ranges to
+                        include.
+
+                        For example: "65, 66, 67" or "32-127" or
+                        "0x30-0x39, 0x41-0x5a"
+
+  -s STRING, --string STRING
+                        String of characters to include For example:
+                        "1234567890-."
+
+The module has the same layout as font2bitmap modules with BPP = 8. Each
+glyph is a distance field WIDTHS[i] pixels wide and HEIGHT pixels high that
+includes SPREAD pixels of padding on every side. Values are 128 on the edge
+of the character, increasing inside it and decreasing outside of it by
+127 / SPREAD per pixel.
+'''
+
+import sys
+import shlex
+import argparse
+import bisect
+import math
+import freetype
+
+# resolution of the rendered characters the distance fields are sampled from
+OVERSAMPLE = 4
+
+INF = 1e20
+
+
+def to_int(string):
+    """ Return integer value from a hex or decimal string"""
+    return int(string, base=16) if string.startswith("0x") else int(string)
+
+
+def get_chars(string):
+    """ Return string comprised of given characters or range(s) of characters"""
+    return ''.join(chr(b) for a in [
+            (lambda sub: range(sub[0], sub[-1] + 1))
+            (list(map(to_int, ele.split('-'))))
+            for ele in string.split(',')] for b in a)
+
+
+def wrap_str(string, items_per_line=32):
+    """ Return a string wrapped to items_per_line with special care for escape characters"""
+    length = len(string)
+    lines = []
+    i = 0
+    end = 0
+    while length > end:
+        end = min(i + items_per_line, length)
+        if string[end - 1] == '\\':
+            end -= 2
+        lines.append(string[i : end])
+        i = end
+    return "(\n    '" + "'\n    '".join(lines) + "'\n)"
+
+
+def wrap_bytes(lst, items_per_line=16):
+    """Return a string of items wrapped to items_per_line"""
+    lines = [
+        "".join(f'\\x{x:02x}' for x in lst[i : i + items_per_line])
+        for i in range(0, len(lst), items_per_line)
+    ]
+    return "    b'" + "'\\\n    b'".join(lines) + "'"
+
+
+def edt_1d(f):
+    """
+    Return the squared distance transform of the sampled function f using
+    the lower envelope of parabolas from Felzenszwalb and Huttenlocher,
+    Distance Transforms of Sampled Functions.
+    """
+    n = len(f)
+    d = [0.0] * n
+    v = [0] * n
+    z = [0.0] * (n + 1)
+    k = 0
+    z[0] = -INF
+    z[1] = INF
+
+    for q in range(1, n):
+        s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k])
+        while s <= z[k]:
+            k -= 1
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k])
+        k += 1
+        v[k] = q
+        z[k] = s
+        z[k + 1] = INF
+
+    k = 0
+    for q in range(n):
+        while z[k + 1] < q:
+            k += 1
+        d[q] = (q - v[k]) ** 2 + f[v[k]]
+    return d
+
+
+def edt(mask, width, height):
+    """
+    Return the euclidean distance from every pixel to the nearest pixel
+    where mask is true.
+    """
+    grid = [0.0 if m else INF for m in mask]
+
+    for x in range(width):
+        column = edt_1d(grid[x::width])
+        for y in range(height):
+            grid[y * width + x] = column[y]
+
+    for y in range(height):
+        row = y * width
+        grid[row:row + width] = edt_1d(grid[row:row + width])
+
+    return [math.sqrt(d) for d in grid]
+
+
+class SdfFont():
+    def __init__(self, filename, height, spread):
+        self.face = freetype.Face(filename)
+        self.height = height
+        self.spread = spread
+
+        # render characters so the line height is about OVERSAMPLE times the
+        # distance field height, then measure the actual pixels per sample.
+        self.face.set_pixel_sizes(0, height * OVERSAMPLE)
+        self.ascender = self.face.size.ascender >> 6
+        descender = self.face.size.descender >> 6
+        self.step = (self.ascender - descender) / height
+
+    def distance_field(self, char):
+        """Return the width and distance field bytes of char."""
+        self.face.load_char(char, freetype.FT_LOAD_RENDER | freetype.FT_LOAD_TARGET_NORMAL)
+        slot = self.face.glyph
+        bitmap = slot.bitmap
+        step = self.step
+        spread = self.spread
+
+        advance = max(1, round((slot.advance.x >> 6) / step))
+        width = advance + spread * 2
+        height = self.height + spread * 2
+
+        # draw the character into an oversampled cell with room for the spread
+        cell_width = math.ceil(width * step)
+        cell_height = math.ceil(height * step)
+        inside = [False] * (cell_width * cell_height)
+        left = round(spread * step) + slot.bitmap_left
+        top = round(spread * step) + self.ascender - slot.bitmap_top
+
+        for y in range(bitmap.rows):
+            cy = top + y
+            if 0 <= cy < cell_height:
+                for x in range(bitmap.width):
+                    cx = left + x
+                    if 0 <= cx < cell_width and bitmap.buffer[y * bitmap.pitch + x] >= 128:
+                        inside[cy * cell_width + cx] = True
+
+        to_inside = edt(inside, cell_width, cell_height)
+        to_outside = edt([not i for i in inside], cell_width, cell_height)
+
+        field = bytearray(width * height)
+        for y in range(height):
+            cy = min(cell_height - 1, int((y + 0.5) * step))
+            for x in range(width):
+                cx = min(cell_width - 1, int((x + 0.5) * step))
+                i = cy * cell_width + cx
+
+                # distance to the edge half way between pixels, in samples
+                if inside[i]:
+                    distance = (to_outside[i] - 0.5) / step
+                else:
+                    distance = -(to_inside[i] - 0.5) / step
+
+                value = round(128 + distance * 127 / spread)
+                field[y * width + x] = max(0, min(255, value))
+
+        return width, field
+
+    def write_python(self, text, font_file):
+        widths = []
+        offsets = []
+        fields = bytearray()
+
+        for char in text:
+            width, field = self.distance_field(char)
+            widths.append(width)
+            offsets.append(len(fields) * 8)
+            fields.extend(field)
+
+        # escape backslash, quote and single quote characters for char_map
+        text_escaped = text.replace('\\', '\\\\').replace('"', '\\"').replace("'", "\\'")
+        char_map = wrap_str(text_escaped)
+
+        cmd_line = " ".join(map(shlex.quote, sys.argv))
+
+        # write python module source
+        print('# -*- coding: utf-8 -*-')
+        print(f'# Converted from {font_file} using:')
+        print(f'#     {cmd_line}')
+        print()
+
+        print(f'MAP = {char_map}\n')
+        print('BPP = 8')
+        print(f'HEIGHT = {self.height + self.spread * 2}')
+        print(f'MAX_WIDTH = {max(widths)}')
+        print(f'SPREAD = {self.spread}')
+        print('_WIDTHS = \\')
+        print(wrap_bytes(widths))
+        print()
+
+        byte_offsets = bytearray()
+        bytes_table = [0xff, 0xffff, 0xffffff, 0xffffffff]
+        bytes_required = bisect.bisect_left(bytes_table, offsets[-1], 0, 3) + 1
+        for offset in offsets:
+            byte_offsets.extend(offset.to_bytes(bytes_required, 'big'))
+
+        print(f'OFFSET_WIDTH = {bytes_required}')
+        print('_OFFSETS = \\')
+        print(wrap_bytes(byte_offsets))
+        print()
+
+        print('_BITMAPS =\\')
+        print(wrap_bytes(fields))
+        print("\nWIDTHS = memoryview(_WIDTHS)")
+        print("OFFSETS = memoryview(_OFFSETS)")
+        print("BITMAPS = memoryview(_BITMAPS)")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        prog='font2sdf',
+        description=('''
+            Convert characters from a truetype font to a signed distance field
+            font module for use with the write_sdf method of the s3lcd
+            driver.'''))
+
+    parser.add_argument(
+        'font_file',
+        help='name of font file to convert.')
+
+    parser.add_argument(
+        'font_height',
+        type=int,
+        help='height in pixels of the distance fields, 32 works well.')
+
+    parser.add_argument(
+        '-r', '--spread',
+        type=int,
+        default=4,
+        help='distance field spread in pixels, defaults to 4.')
+
+    group = parser.add_argument_group(
+        'character selection',
+        'characters from the font to include in the module.')
+
+    excl = group.add_mutually_exclusive_group(required=True)
+    excl.add_argument(
+        '-c', '--characters',
+        help='''integer or hex character values and/or ranges to include.
+        For example: "65, 66, 67" or "32-127" or "0x30-0x39, 0x41-0x5a"''')
+
+    excl.add_argument(
+        '-s', '--string',
+        help='''string of characters to include
+        For example: "1234567890-."''')
+
+    args = parser.parse_args()
+    characters = get_chars(args.characters) if args.string is None else args.string
+
+    fnt = SdfFont(args.font_file, args.font_height, args.spread)
+    fnt.write_python(characters, args.font_file)
+
+
+main()